@@ -4,9 +4,19 @@
  * This file is the starter project for the BASIC interpreter.
  */
 
+#include <algorithm>
 #include <cctype>
+#include <cstdlib>
+#include <exception>
 #include <iostream>
+#include <memory>
+#include <numeric>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <csignal>
+#include <unistd.h>
 #include "program.hpp"
 #include "Utils/error.hpp"
 #include "Utils/tokenScanner.hpp"
@@ -14,16 +24,84 @@
 #include "evalstate.hpp"
 #include "exp.hpp"
 #include "parser.hpp"
+#include "keyword.hpp"
+#include "output.hpp"
+#include "loader.hpp"
+#include "compiler.hpp"
+#ifdef BASIC_COUNT_ALLOCS
+#include "alloccount.hpp"
+#endif
 
+#ifdef BASIC_COUNT_ALLOCS
+
+/*
+ * Type: AllocationReport
+ * ----------------------
+ * Reports on standard error how many allocations were made while it
+ * was in scope.  It is left however RUN ends, so a run stopped by an
+ * error is counted like any other.
+ */
+
+struct AllocationReport {
+    long start = getAllocationCount();
+    ~AllocationReport() {
+        long allocations = getAllocationCount() - start;
+        std::cerr << "RUN: " << allocations << " allocations" << '\n';
+    }
+};
+
+#endif
+
+
+/*
+ * Type: ParsedLine
+ * ----------------
+ * The outcome of parsing a numbered line, kept apart from the program
+ * so that lines can be parsed on worker threads and installed later.
+ * The fields record what processLine would do to the program:
+ *
+ *   hasNumber -- the line number could be read at all
+ *   keepText  -- the text stays in the program; false if it is removed
+ *   stmt      -- the statement to install, or nullptr
+ *   error     -- the exception to raise once the line is installed
+ */
+
+struct ParsedLine {
+    int lineNumber = 0;
+    bool hasNumber = false;
+    bool keepText = true;
+    Statement *stmt = nullptr;
+    std::exception_ptr error;
+};
 
 /* Function prototypes */
 
-void processLine(std::string line, Program &program, EvalState &state);
+void processLine(std::string_view line, Program &program, EvalState &state);
+
+void parseNumberedLine(const std::string &firstToken, TokenScanner &scanner, ParsedLine &parsed);
+
+void installLine(std::string_view line, ParsedLine &parsed, Program &program, EvalState &state);
+
+void loadLines(const std::string_view *lines, size_t count, int jobs, Program &program, EvalState &state);
+
+void reportError(ErrorException &ex);
+
+void executeLine(std::string_view line, Program &program, EvalState &state);
+
+int runScript(const char *path, int jobs, Program &program, EvalState &state);
+
+int compileScript(const char *path, const std::string &output, int jobs, Program &program, EvalState &state);
+
+void installFatalHandlers();
+
+void flushAndAbort();
+
+void flushAndRaise(int sig);
 
 /* Main program */
 
-bool check_varname(std::string varName) {
-    if (varName == "REM" || varName == "LET" || varName == "PRINT" || varName == "INPUT" || varName == "END" || varName == "GOTO" || varName == "IF" ||varName == "THEN" || varName == "RUN"||varName == "LIST" || varName == "CLEAR" ||varName == "QUIT" || varName == "HELP") {
+bool check_varname(const std::string &varName) {
+    if (isKeyword(classifyToken(varName))) {
         return false;
     }
     for (int i = 0; i < varName.size(); i++) {
@@ -34,24 +112,307 @@ bool check_varname(std::string varName) {
     return true;
 }
 
-int main() {
-    EvalState state;
-    Program program;
-    //std::cout << "Stub implementation of BASIC" << std::endl;
-    while (true) {
+/*
+ * Function: parseCondition
+ * Usage: Expression *exp = parseCondition(text);
+ * ----------------------------------------------
+ * Parses one side of an IF comparison.  This runs once when the line
+ * is entered, so executing the IF only has to evaluate the two trees.
+ */
+
+Expression *parseCondition(std::string text) {
+    TokenScanner scanner;
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    scanner.scanStrings();
+    scanner.setInput(std::string_view(text));
+    return parseExp(scanner);
+}
+
+/*
+ * Function: reportError
+ * Usage: reportError(ex);
+ * -----------------------
+ * Writes the message of an error to standard output on a line of its
+ * own, as every error of the interpreter is reported.
+ */
+
+void reportError(ErrorException &ex) {
+    OutputSink &out = standardOutput();
+    out.write(ex.getMessage());
+    out.endLine();
+    out.notify(FLUSH_ON_ERROR);
+}
+
+/*
+ * Function: executeLine
+ * Usage: executeLine(line, program, state);
+ * -----------------------------------------
+ * Processes one line of input, reporting any error it raises.  Empty
+ * lines are ignored.
+ */
+
+void executeLine(std::string_view line, Program &program, EvalState &state) {
+    if (line.empty()) return;
+    try {
+        processLine(line, program, state);
+    } catch (ErrorException &ex) {
+        reportError(ex);
+    }
+}
+
+/*
+ * Function: isNumberedLine
+ * Usage: if (isNumberedLine(line)) ...
+ * ------------------------------------
+ * Returns true if the first token of the line is a line number, which
+ * is the case exactly when its first non-blank character is a digit.
+ */
+
+static bool isNumberedLine(std::string_view line) {
+    for (char ch : line) {
+        if (!isspace((unsigned char) ch)) return isdigit((unsigned char) ch);
+    }
+    return false;
+}
+
+/*
+ * Function: runScript
+ * Usage: int status = runScript(path, jobs, program, state);
+ * ----------------------------------------------------------
+ * Executes the lines of a script file in order, exactly as if they
+ * had been typed on standard input.  The file is mapped into memory
+ * and split into lines in one pass, and each run of numbered lines
+ * between two commands is handed to loadLines, which may parse it on
+ * up to jobs threads.  Returns the exit status.
+ */
+
+int runScript(const char *path, int jobs, Program &program, EvalState &state) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "code: cannot open " << path << '\n';
+        return 1;
+    }
+    std::vector<std::string_view> lines;
+    splitLines(file.getText(), lines);
+    size_t start = 0;
+    while (start < lines.size()) {
+        size_t end = start;
+        while (end < lines.size() && isNumberedLine(lines[end])) {
+            end++;
+        }
+        loadLines(lines.data() + start, end - start, jobs, program, state);
+        if (end < lines.size()) executeLine(lines[end], program, state);
+        start = end + 1;
+    }
+    return 0;
+}
+
+/*
+ * Function: compileScript
+ * Usage: int status = compileScript(path, output, jobs, program, state);
+ * ----------------------------------------------------------------------
+ * Loads the numbered lines of a script file and compiles the program
+ * they form into the executable output, as COMPILE would.  The
+ * commands in the file are not executed.  Returns the exit status.
+ */
+
+int compileScript(const char *path, const std::string &output, int jobs, Program &program, EvalState &state) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "code: cannot open " << path << '\n';
+        return 1;
+    }
+    std::vector<std::string_view> lines;
+    splitLines(file.getText(), lines);
+    lines.erase(std::remove_if(lines.begin(), lines.end(), [](std::string_view line) {
+        return !isNumberedLine(line);
+    }), lines.end());
+    loadLines(lines.data(), lines.size(), jobs, program, state);
+    try {
+        compileProgram(program, state, output);
+    } catch (ErrorException &ex) {
+        reportError(ex);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Function: parseLines
+ * Usage: parseLines(lines, count, parsed);
+ * ----------------------------------------
+ * Parses count numbered lines into the matching entries of parsed.
+ * This is the work done by one worker of loadLines; it only touches
+ * its own entries and the arena current on its thread.
+ */
+
+static void parseLines(const std::string_view *lines, size_t count, ParsedLine *parsed) {
+    for (size_t i = 0; i < count; i++) {
+        TokenScanner scanner;
+        scanner.ignoreWhitespace();
+        scanner.scanNumbers();
+        scanner.scanStrings();
+        scanner.setInput(lines[i]);
+        std::string firstToken = scanner.nextToken();
+        parseNumberedLine(firstToken, scanner, parsed[i]);
+    }
+}
+
+/*
+ * Function: loadLines
+ * Usage: loadLines(lines, count, jobs, program, state);
+ * -----------------------------------------------------
+ * Enters count numbered lines into the program, with the same result
+ * as passing them one by one to executeLine.  Batches large enough to
+ * be worth it are split into contiguous slices that are parsed on up
+ * to jobs threads, each into its own arena.
+ */
+
+static const size_t MIN_LINES_PER_JOB = 4096;
+
+void loadLines(const std::string_view *lines, size_t count, int jobs, Program &program, EvalState &state) {
+    size_t workerCount = std::min((size_t) std::max(jobs, 1), count / MIN_LINES_PER_JOB);
+    if (workerCount <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            executeLine(lines[i], program, state);
+        }
+        return;
+    }
+    std::vector<ParsedLine> parsed(count);
+    std::vector<std::unique_ptr<NodeArena>> arenas;
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < workerCount; w++) {
+        size_t first = count * w / workerCount;
+        size_t last = count * (w + 1) / workerCount;
+        arenas.push_back(std::make_unique<NodeArena>());
+        NodeArena *arena = arenas.back().get();
+        ParsedLine *slice = parsed.data() + first;
+        auto work = [=] {
+            ArenaScope scope(*arena);
+            parseLines(lines + first, last - first, slice);
+        };
+        try {
+            workers.emplace_back(work);
+        } catch (std::system_error &) {
+            work();
+        }
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    for (std::unique_ptr<NodeArena> &arena : arenas) {
+        program.getArena().adopt(*arena);
+    }
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return parsed[a].lineNumber < parsed[b].lineNumber;
+    });
+    for (size_t i : order) {
+        installLine(lines[i], parsed[i], program, state);
+    }
+    for (ParsedLine &line : parsed) {
+        if (!line.error) continue;
         try {
-            std::string input;
-            getline(std::cin, input);
-            if (input.empty())
-                continue;
-            processLine(input, program, state);
+            std::rethrow_exception(line.error);
         } catch (ErrorException &ex) {
-            std::cout << ex.getMessage() << std::endl;
+            reportError(ex);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    EvalState state;
+    Program program;
+    OutputSink &out = standardOutput();
+    if (isatty(STDOUT_FILENO)) {
+        out.setFlushPolicy(FLUSH_ON_INPUT | FLUSH_ON_ERROR | FLUSH_ON_NEWLINE);
+    }
+    installFatalHandlers();
+    int jobs = std::max(1, (int) std::thread::hardware_concurrency());
+    std::string output;
+    int arg = 1;
+    while (arg < argc && argv[arg][0] == '-') {
+        std::string option = argv[arg++];
+        if (option == "-j" && arg < argc) {
+            jobs = std::max(1, atoi(argv[arg++]));
+        } else if (option == "--jit") {
+            program.setJitEnabled(true);
+        } else if (option == "--dump-cfg") {
+            program.setGraphDumpEnabled(true);
+        } else if (option == "--compile" && arg < argc) {
+            output = argv[arg++];
+        } else {
+            arg = argc + 1;
         }
     }
+    if (arg > argc || (!output.empty() && arg == argc)) {
+        std::cerr << "usage: code [-j jobs] [--jit] [--dump-cfg] [program.bas]" << '\n';
+        std::cerr << "       code [-j jobs] [--dump-cfg] --compile output program.bas" << '\n';
+        return 2;
+    }
+    if (!output.empty()) {
+        return compileScript(argv[arg], output, jobs, program, state);
+    }
+    if (arg < argc) {
+        return runScript(argv[arg], jobs, program, state);
+    }
+    //std::cout << "Stub implementation of BASIC" << std::endl;
+    std::string input;
+    while (getline(std::cin, input)) {
+        executeLine(input, program, state);
+    }
     return 0;
 }
 
+/*
+ * Function: installFatalHandlers
+ * Usage: installFatalHandlers();
+ * ------------------------------
+ * Makes sure that the output buffered in standardOutput() is written
+ * when the interpreter dies without running static destructors: on an
+ * exception nobody catches, and on the signals with which a terminal
+ * or a time limit stops a process.
+ */
+
+static std::terminate_handler defaultTerminate;
+
+static OutputSink *fatalOutput;
+
+void installFatalHandlers() {
+    fatalOutput = &standardOutput();
+    defaultTerminate = std::set_terminate(flushAndAbort);
+    struct sigaction action = {};
+    action.sa_handler = flushAndRaise;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGHUP, &action, nullptr);
+}
+
+/*
+ * Implementation notes: flushAndAbort, flushAndRaise
+ * --------------------------------------------------
+ * The terminate handler flushes and hands over to the one it replaced,
+ * which reports the exception and aborts.  The signal handler may run
+ * in the middle of anything, including the sink itself or malloc, so
+ * it only writes out what is left in the buffer and raises the signal
+ * again, which by then has its default action back, so the process
+ * still ends the way its parent expects.
+ */
+
+void flushAndAbort() {
+    standardOutput().flush();
+    defaultTerminate();
+}
+
+void flushAndRaise(int sig) {
+    fatalOutput->flushFromSignal();
+    raise(sig);
+}
+
 /*
  * Function: processLine
  * Usage: processLine(line, program, state);
@@ -64,7 +425,7 @@ int main() {
  * or one of the BASIC commands, such as LIST or RUN.
  */
 
-void processLine(std::string line, Program &program, EvalState &state) {
+void processLine(std::string_view line, Program &program, EvalState &state) {
     TokenScanner scanner;
     scanner.ignoreWhitespace();
     scanner.scanNumbers();
@@ -73,166 +434,228 @@ void processLine(std::string line, Program &program, EvalState &state) {
     if (scanner.hasMoreTokens()) {
         std::string firstToken = scanner.nextToken();
         if (isdigit(firstToken[0])) {
-            int lineNumber = std::stoi(firstToken);
-            program.addSourceLine(lineNumber, line);
-            if (scanner.hasMoreTokens()) {
-                std::string command = scanner.nextToken();
-                if (command == "REM") {
-                    Statement* stmt = new RemStatement();
-                    program.setParsedStatement(lineNumber, stmt);
+            ParsedLine parsed;
+            {
+                ArenaScope scope(program.getArena());
+                parseNumberedLine(firstToken, scanner, parsed);
+            }
+            installLine(line, parsed, program, state);
+            if (parsed.error) std::rethrow_exception(parsed.error);
+        }
+        else {
+            switch (classifyToken(firstToken)) {
+                case KW_LIST: {
+                    program.listProgram();
+                    return;
+                }
+                case KW_QUIT:
+                    program.clear();
+                    state.Clear();
+                    exit(0);
+                case KW_CLEAR:
+                    program.clear();
+                    state.Clear();
+                    return;
+                case KW_RUN: {
+                    program.link();
+#ifdef BASIC_COUNT_ALLOCS
+                    AllocationReport report;
+#endif
+                    program.run(state);
                     return;
                 }
-                else if (command == "LET") {
-                    std::string VarName = scanner.nextToken();
-                    if (!check_varname(VarName)) {
+                case KW_COMPILE: {
+                    std::string path = scanner.nextToken();
+                    if (path.size() >= 2 && (path[0] == '"' || path[0] == '\'') && path.back() == path[0]) {
+                        path = path.substr(1, path.size() - 2);
+                    }
+                    if (path.empty() || scanner.hasMoreTokens()) {
                         error("SYNTAX ERROR");
                     }
-                    scanner.nextToken();
-                    Expression* expression = parseExp(scanner);
-                    Statement* stmt = new LetStatement(VarName, expression);
-                    program.setParsedStatement(lineNumber,stmt);
+                    compileProgram(program, state, path);
                     return;
                 }
-                else if (command == "PRINT") {
+                case KW_PRINT: {
                     Expression* expr = nullptr;
                     if (scanner.hasMoreTokens()) {
                         expr = parseExp(scanner);
                     }
-                    else {
-                        error("SYNTAX ERROR");
-                    }
                     Statement *stmt = new PrintStatement(expr);
-                    program.setParsedStatement(lineNumber,stmt);
-                    return;
-                }
-                else if (command == "INPUT") {
-                    std::string name = scanner.nextToken();
-                    Statement*stmt =new InputStatement(name);
-                    program.setParsedStatement(lineNumber, stmt);
+                    try {
+                        stmt->resolve(state);
+                        stmt->execute(program, state);
+                    } catch (ErrorException &ex) {
+                        reportError(ex);
+                    }
+                    delete stmt;
                     return;
                 }
-                else if (command == "END") {
-                    if (scanner.hasMoreTokens()) {
+                case KW_LET: {
+                    std::string varname = scanner.nextToken();
+                    if (isKeyword(classifyToken(varname))) {
                         error("SYNTAX ERROR");
                     }
-                    else {
-                        Statement* stmt = new EndStatement();
-                        program.setParsedStatement(lineNumber,stmt);
+                    scanner.nextToken();
+                    Expression*expr = parseExp(scanner);
+                    Statement* stmt = new LetStatement(varname,expr);
+                    try {
+                        stmt->resolve(state);
+                        stmt->execute(program, state);
+                    } catch (ErrorException &ex) {
+                        reportError(ex);
                     }
+                    delete stmt;
                     return;
                 }
-                else if (command == "IF") {
-                    std::string condition = "";
-                    while (scanner.hasMoreTokens()) {
-                        std::string s = scanner.nextToken();
-                        if (s == "THEN") break;
-                        condition += s;
-                        condition += " ";
-                    }
-                    std::string str_num = "";
-                    while (scanner.hasMoreTokens()) {
-                        std::string s = scanner.nextToken();
-                        str_num += s;
-                    }
-                    int number = std::stoi(str_num);
-                    Statement* stmt = new IfStatement(condition, number);
-                    program.setParsedStatement(lineNumber,stmt);
-                }
-                else if (command == "GOTO") {
-                    int number = std::stoi(scanner.nextToken());
-                    Statement*stmt = new GotoStatement(number);
-                    program.setParsedStatement(lineNumber,stmt);
+                case KW_INPUT: {
+                    std::string name = scanner.nextToken();
+                    Statement*stmt =new InputStatement(name);
+                    stmt->resolve(state);
+                    stmt->execute(program, state);
+                    delete stmt;
                     return;
                 }
-                else {
-                    program.removeSourceLine(lineNumber);
-                    error("SYNTAX ERROR");
-                }
-                return;
-            }
-            else {
-                program.removeSourceLine(lineNumber);
+                default:
+                    return;
             }
         }
-        else {
-            if (firstToken == "LIST") {
-                int cur = program.getFirstLineNumber();
-                while (cur != -1) {
-                    std::cout << program.getSourceLine(cur) << std::endl;
-                    cur = program.getNextLineNumber(cur);
-                }
-                return;
-            }
-            else if (firstToken == "QUIT") {
-                program.clear();
-                state.Clear();
-                exit(0);
-            }
-            else if (firstToken == "CLEAR") {
-                program.clear();
-                state.Clear();
+    }
+    else return;
+}
+
+/*
+ * Function: parseNumberedLine
+ * Usage: parseNumberedLine(firstToken, scanner, parsed);
+ * ------------------------------------------------------
+ * Parses a numbered line whose first token has already been read,
+ * recording the outcome in parsed instead of changing the program.
+ * Any exception is caught and stored in parsed.error.  The nodes are
+ * created in the arena that is current on the calling thread.
+ */
+
+void parseNumberedLine(const std::string &firstToken, TokenScanner &scanner, ParsedLine &parsed) {
+    try {
+        parsed.lineNumber = std::stoi(firstToken);
+        parsed.hasNumber = true;
+        if (!scanner.hasMoreTokens()) {
+            parsed.keepText = false;
+            return;
+        }
+        std::string command = scanner.nextToken();
+        switch (classifyToken(command)) {
+            case KW_REM: {
+                Statement* stmt = new RemStatement();
+                parsed.stmt = stmt;
                 return;
             }
-            else if (firstToken == "RUN") {
-                program.run();
-                int cur = program.getFirstLineNumber();
-                program.goto_line(cur);
-                while (cur != -1 && !(program.if_end())) {
-                    Statement *stmt = program.getParsedStatement(cur);
-                    if (stmt != nullptr) {
-                        stmt->execute(program, state);
-                    }
-                    cur  = program.get_cur_linenumber();
-                    if (!program.check_jump()) {
-                        cur = program.getNextLineNumber(cur);
-                    }
-                    else {
-                        program.not_jump();
-                    }
-                    program.goto_line(cur);
-                    cur = program.get_cur_linenumber();
+            case KW_LET: {
+                std::string VarName = scanner.nextToken();
+                if (!check_varname(VarName)) {
+                    error("SYNTAX ERROR");
                 }
+                scanner.nextToken();
+                Expression* expression = parseExp(scanner);
+                Statement* stmt = new LetStatement(VarName, expression);
+                parsed.stmt = stmt;
                 return;
             }
-            else if (firstToken == "PRINT") {
+            case KW_PRINT: {
                 Expression* expr = nullptr;
                 if (scanner.hasMoreTokens()) {
                     expr = parseExp(scanner);
                 }
-                Statement *stmt = new PrintStatement(expr);
-                try {
-                    stmt->execute(program, state);  
-                } catch (ErrorException &ex) {
-                    std::cout << ex.getMessage() << std::endl;
+                else {
+                    error("SYNTAX ERROR");
                 }
-                delete stmt;
+                Statement *stmt = new PrintStatement(expr);
+                parsed.stmt = stmt;
                 return;
             }
-            else if (firstToken == "LET") {
-                std::string varname = scanner.nextToken();
-                if(varname =="LET" || varname =="IF" || varname =="REM" || varname =="GOTO" || varname =="PRINT" || varname =="INPUT" || varname =="END" || varname =="THEN" || varname =="RUN" || varname =="LIST" ||varname =="CLEAR"||varname =="QUIT") {
+            case KW_INPUT: {
+                std::string name = scanner.nextToken();
+                Statement*stmt =new InputStatement(name);
+                parsed.stmt = stmt;
+                return;
+            }
+            case KW_END: {
+                if (scanner.hasMoreTokens()) {
                     error("SYNTAX ERROR");
                 }
-                scanner.nextToken();
-                Expression*expr = parseExp(scanner);
-                Statement* stmt = new LetStatement(varname,expr);
+                else {
+                    Statement* stmt = new EndStatement();
+                    parsed.stmt = stmt;
+                }
+                return;
+            }
+            case KW_IF: {
+                std::string left = "";
+                std::string right = "";
+                char op = 0;
+                while (scanner.hasMoreTokens()) {
+                    std::string s = scanner.nextToken();
+                    TokenKind kind = classifyToken(s);
+                    if (kind == KW_THEN) break;
+                    if (op == 0 && (kind == TOK_LESS || kind == TOK_EQUALS || kind == TOK_GREATER)) {
+                        op = s[0];
+                        continue;
+                    }
+                    std::string &side = (op == 0) ? left : right;
+                    side += s;
+                    side += " ";
+                }
+                std::string str_num = "";
+                while (scanner.hasMoreTokens()) {
+                    std::string s = scanner.nextToken();
+                    str_num += s;
+                }
+                int number = std::stoi(str_num);
+                Expression *lhs = nullptr;
+                Expression *rhs = nullptr;
                 try {
-                    stmt->execute(program, state);
+                    if (op == 0) error("SYNTAX ERROR");
+                    lhs = parseCondition(left);
+                    rhs = parseCondition(right);
                 } catch (ErrorException &ex) {
-                    std::cout << ex.getMessage() << std::endl;
+                    delete lhs;
+                    parsed.keepText = false;
+                    error("SYNTAX ERROR");
                 }
-                delete stmt;
+                Statement* stmt = new IfStatement(lhs, op, rhs, number);
+                parsed.stmt = stmt;
                 return;
             }
-            else if (firstToken == "INPUT") {
-                std::string name = scanner.nextToken();
-                Statement*stmt =new InputStatement(name);
-                stmt->execute(program, state);
-                delete stmt;
+            case KW_GOTO: {
+                int number = std::stoi(scanner.nextToken());
+                Statement*stmt = new GotoStatement(number);
+                parsed.stmt = stmt;
                 return;
             }
+            default:
+                parsed.keepText = false;
+                error("SYNTAX ERROR");
         }
+    } catch (...) {
+        parsed.error = std::current_exception();
+    }
+}
+
+/*
+ * Function: installLine
+ * Usage: installLine(line, parsed, program, state);
+ * -------------------------------------------------
+ * Applies a parsed line to the program: stores its text, removes it
+ * again if the line is empty or its error says so, and installs and
+ * resolves its statement.  The error itself is left to the caller.
+ */
+
+void installLine(std::string_view line, ParsedLine &parsed, Program &program, EvalState &state) {
+    if (!parsed.hasNumber) return;
+    ArenaScope scope(program.getArena());
+    program.addSourceLine(parsed.lineNumber, line);
+    if (!parsed.keepText) program.removeSourceLine(parsed.lineNumber);
+    if (parsed.stmt != nullptr) {
+        program.setParsedStatement(parsed.lineNumber, parsed.stmt);
+        parsed.stmt->resolve(state);
     }
-    else return;
 }
     //todo
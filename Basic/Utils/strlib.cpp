@@ -5,6 +5,7 @@
  */
 
 #include <cctype>
+#include <charconv>
 #include <iomanip>
 #include <iostream>
 #include "error.hpp"
@@ -15,7 +16,9 @@
 /*
  * Implementation notes: numeric conversion
  * ----------------------------------------
- * These functions use the <sstream> library to perform the conversion.
+ * These functions use the <sstream> library to perform the conversion,
+ * except for the integer parsers, which are built on std::from_chars
+ * so that reading a number never constructs a stream.
  */
 
 std::string integerToString(int n) {
@@ -25,17 +28,37 @@ std::string integerToString(int n) {
 }
 
 int stringToInteger(std::string str) {
-
-    std::istringstream stream(str);
-    int value;
-    stream >> value;
-    if (!stream.eof()) stream >> std::ws;
-    if (stream.fail() || !stream.eof()) {
-        error("stringToInteger: Illegal integer format (" + str + ")");
+    std::string_view text = str;
+    while (!text.empty() && isspace((unsigned char) text.front())) text.remove_prefix(1);
+    while (!text.empty() && isspace((unsigned char) text.back())) text.remove_suffix(1);
+    if (text.size() > 1 && text[0] == '+' && text[1] != '-') text.remove_prefix(1);
+    int value = 0;
+    switch (parseInteger(text, value)) {
+        case INTEGER_OK:
+            break;
+        case INTEGER_OVERFLOW:
+            error("stringToInteger: Integer out of range (" + str + ")");
+            break;
+        case INTEGER_INVALID:
+            error("stringToInteger: Illegal integer format (" + str + ")");
+            break;
     }
     return value;
 }
 
+IntegerParseStatus parseInteger(std::string_view str, int &value) {
+    if (str.empty()) return INTEGER_INVALID;
+    const char *first = str.data();
+    const char *last = first + str.size();
+    int result;
+    std::from_chars_result parsed = std::from_chars(first, last, result);
+    if (parsed.ptr != last) return INTEGER_INVALID;
+    if (parsed.ec == std::errc::result_out_of_range) return INTEGER_OVERFLOW;
+    if (parsed.ec != std::errc()) return INTEGER_INVALID;
+    value = result;
+    return INTEGER_OK;
+}
+
 std::string realToString(double d) {
     std::ostringstream stream;
     stream << std::uppercase << d;
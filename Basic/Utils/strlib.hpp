@@ -10,6 +10,7 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 
 /*
  * Function: integerToString
@@ -34,6 +35,33 @@ std::string integerToString(int n);
 
 int stringToInteger(std::string str);
 
+/*
+ * Type: IntegerParseStatus
+ * ------------------------
+ * This enumerated type reports the outcome of <code>parseInteger</code>.
+ */
+
+enum IntegerParseStatus {
+    INTEGER_OK, INTEGER_INVALID, INTEGER_OVERFLOW
+};
+
+/*
+ * Function: parseInteger
+ * Usage: IntegerParseStatus status = parseInteger(str, value);
+ * ------------------------------------------------------------
+ * Parses a decimal integer that fills the whole of <code>str</code>:
+ * an optional minus sign followed by one or more digits, with no
+ * surrounding whitespace.  On success the result is stored in
+ * <code>value</code> and the function returns <code>INTEGER_OK</code>.
+ * Otherwise <code>value</code> is left unchanged and the function
+ * returns <code>INTEGER_OVERFLOW</code> if the text is a well-formed
+ * integer outside the range of <code>int</code>, or
+ * <code>INTEGER_INVALID</code> for anything else.  The function does
+ * not allocate memory.
+ */
+
+IntegerParseStatus parseInteger(std::string_view str, int &value);
+
 /*
  * Function: realToString
  * Usage: string s = realToString(d);
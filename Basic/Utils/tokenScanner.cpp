@@ -8,11 +8,27 @@
 #include "error.hpp"
 #include "tokenScanner.hpp"
 #include "strlib.hpp"
-#include "sstream"
+#include <sstream>
+
+/*
+ * Functions: isSpaceChar, isAlnumChar
+ * -----------------------------------
+ * Inline versions of isspace and isalnum for the "C" locale, which is
+ * the one the interpreter runs in.  The scanner tests every character
+ * of its input with them, so they save a library call per character.
+ */
+
+static inline bool isSpaceChar(int ch) {
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+static inline bool isAlnumChar(int ch) {
+    return (ch >= '0' && ch <= '9') || ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'z');
+}
 
 TokenScanner::TokenScanner() {
     initScanner();
-    setInput("");
+    setInput(std::string_view());
 }
 
 TokenScanner::TokenScanner(std::string str) {
@@ -26,107 +42,124 @@ TokenScanner::TokenScanner(std::istream &infile) {
 }
 
 TokenScanner::~TokenScanner() {
-    delete isp;
-    //delete savedTokens chain
-    StringCell *pre = savedTokens;
-    while (savedTokens) {
-        savedTokens = savedTokens->link;
-        delete pre;
-        pre = savedTokens;
-    }
-    //delete operators chain
-    StringCell *p = operators;
-    while (operators) {
-        operators = operators->link;
-        delete p;
-        p = operators;
+    if (operators != nullptr) {
+        for (OperatorNode *node : operators->first) {
+            freeOperators(node);
+        }
+        delete operators;
     }
 }
 
 void TokenScanner::setInput(std::string str) {
     buffer = str;
-    if (isp != nullptr) delete isp;
-    isp = new std::istringstream(buffer);
-    delete savedTokens;
-    savedTokens = nullptr;
+    setInput(std::string_view(buffer));
+}
+
+void TokenScanner::setInput(std::string_view str) {
+    input = str;
+    cursor = 0;
+    exhausted = false;
+    isp = nullptr;
+    savedCount = 0;
 }
 
 void TokenScanner::setInput(std::istream &infile) {
-    if (isp != nullptr)delete isp;
     isp = &infile;
-    delete savedTokens;
-    savedTokens = nullptr;
+    savedCount = 0;
 }
 
 bool TokenScanner::hasMoreTokens() {
-    std::string token = nextToken();
-    saveToken(token);
-    return (token != "");
+    if (savedCount > 0) return !savedTokens[savedCount - 1].empty();
+    TokenView token = nextTokenView();
+    saveToken(token.text);
+    return !token.text.empty();
 }
 
 std::string TokenScanner::nextToken() {
-    if (savedTokens != nullptr) {
-        StringCell *cp = savedTokens;
-        std::string token = cp->str;
-        savedTokens = cp->link;
-        delete cp;
-        return token;
+    return std::string(nextTokenView().text);
+}
+
+/*
+ * Implementation notes: nextTokenView
+ * -----------------------------------
+ * Each branch only advances the input; the text of the token is taken
+ * afterwards by tokenText, which slices the input string in place or
+ * returns the characters collected from the stream.
+ */
+
+TokenView TokenScanner::nextTokenView() {
+    if (savedCount > 0) {
+        std::string_view token = savedTokens[--savedCount];
+        return {token, getTokenType(token)};
     }
     while (true) {
         if (ignoreWhitespaceFlag) skipSpaces();
-        int ch = isp->get();
+        size_t start = cursor;
+        scratch.clear();
+        int ch = readChar();
         if (ch == '/' && ignoreCommentsFlag) {
-            ch = isp->get();
+            ch = readChar();
             if (ch == '/') {
                 while (true) {
-                    ch = isp->get();
+                    ch = readChar();
                     if (ch == '\n' || ch == '\r' || ch == EOF) break;
                 }
                 continue;
             } else if (ch == '*') {
                 int prev = EOF;
                 while (true) {
-                    ch = isp->get();
+                    ch = readChar();
                     if (ch == EOF || (prev == '*' && ch == '/')) break;
                     prev = ch;
                 }
                 continue;
             }
-            if (ch != EOF) isp->unget();
+            if (ch != EOF) unreadChar();
             ch = '/';
         }
-        if (ch == EOF) return "";
+        if (ch == EOF) return {std::string_view(), TokenType(EOF)};
         if ((ch == '"' || ch == '\'') && scanStringsFlag) {
-            isp->unget();
-            return scanString();
+            unreadChar();
+            scanString();
+            return {tokenText(start), STRING};
         }
         if (isdigit(ch) && scanNumbersFlag) {
-            isp->unget();
-            return scanNumber();
+            unreadChar();
+            scanNumber();
+            return {tokenText(start), NUMBER};
         }
         if (isWordCharacter(ch)) {
-            isp->unget();
-            return scanWord();
-        }
-        std::string op = std::string(1, ch);
-        while (isOperatorPrefix(op)) {
-            ch = isp->get();
-            if (ch == EOF) break;
-            op += ch;
-        }
-        while (op.length() > 1 && !isOperator(op)) {
-            isp->unget();
-            op.erase(op.length() - 1, 1);
+            unreadChar();
+            scanWord();
+            std::string_view token = tokenText(start);
+            return {token, getTokenType(token)};
         }
-        return op;
+        int length = scanOperator(ch);
+        std::string_view token = tokenText(start).substr(0, length);
+        return {token, getTokenType(token)};
     }
 }
 
-void TokenScanner::saveToken(std::string token) {
-    StringCell *cp = new StringCell;
-    cp->str = token;
-    cp->link = savedTokens;
-    savedTokens = cp;
+/*
+ * Implementation notes: saveToken
+ * -------------------------------
+ * When a string is being scanned and the token is the one that ends
+ * at the cursor, the cursor simply moves back to its start, so the
+ * token is scanned again instead of being copied.  Any other token
+ * goes onto the stack of saved tokens.
+ */
+
+void TokenScanner::saveToken(std::string_view token) {
+    if (isp == nullptr && savedCount == 0 && !token.empty() && token.size() <= cursor
+            && token.data() == input.data() + cursor - token.size()) {
+        cursor -= token.size();
+        exhausted = false;
+        return;
+    }
+    if (savedCount == MAX_SAVED_TOKENS) {
+        error("TokenScanner: too many saved tokens");
+    }
+    savedTokens[savedCount++] = token;
 }
 
 void TokenScanner::ignoreWhitespace() {
@@ -150,23 +183,44 @@ void TokenScanner::addWordCharacters(std::string str) {
 }
 
 void TokenScanner::addOperator(std::string op) {
-    StringCell *cp = new StringCell;
-    cp->str = op;
-    cp->link = operators;
-    operators = cp;
+    if (op.empty()) return;
+    if (operators == nullptr) {
+        operators = new OperatorTable();
+    }
+    OperatorNode **slot = &operators->first[(unsigned char) op[0]];
+    for (size_t i = 0; ; i++) {
+        OperatorNode *node = *slot;
+        while (node != nullptr && node->ch != op[i]) {
+            node = node->sibling;
+        }
+        if (node == nullptr) {
+            node = new OperatorNode{op[i], false, nullptr, *slot};
+            *slot = node;
+        }
+        if (i + 1 == op.length()) {
+            node->terminal = true;
+            return;
+        }
+        slot = &node->children;
+    }
 }
 
 int TokenScanner::getPosition() const {
-    if (savedTokens == nullptr) {
-        return int(isp->tellg());
+    int pos = -1;
+    if (isp != nullptr) {
+        pos = int(isp->tellg());
+    } else if (!exhausted) {
+        pos = int(cursor);
+    }
+    if (savedCount == 0) {
+        return pos;
     } else {
-        return int(isp->tellg()) - savedTokens->str.length();
+        return pos - savedTokens[savedCount - 1].length();
     }
-    return -1;
 }
 
 bool TokenScanner::isWordCharacter(char ch) const {
-    return isalnum(ch) || wordChars.find(ch) != std::string::npos;
+    return isAlnumChar((unsigned char) ch) || (!wordChars.empty() && wordChars.find(ch) != std::string::npos);
 };
 
 void TokenScanner::verifyToken(std::string expected) {
@@ -179,9 +233,13 @@ void TokenScanner::verifyToken(std::string expected) {
 };
 
 TokenType TokenScanner::getTokenType(std::string token) const {
-    if (token == "") return TokenType(EOF);
+    return getTokenType(std::string_view(token));
+}
+
+TokenType TokenScanner::getTokenType(std::string_view token) const {
+    if (token.empty()) return TokenType(EOF);
     char ch = token[0];
-    if (isspace(ch)) return SEPARATOR;
+    if (isSpaceChar((unsigned char) ch)) return SEPARATOR;
     if (ch == '"' || (ch == '\'' && token.length() > 1)) return STRING;
     if (isdigit(ch)) return NUMBER;
     if (isWordCharacter(ch)) return WORD;
@@ -264,11 +322,11 @@ std::string TokenScanner::getStringValue(std::string token) const {
 }
 
 int TokenScanner::getChar() {
-    return isp->get();
+    return readChar();
 }
 
 void TokenScanner::ungetChar(int ch) {
-    isp->unget();
+    unreadChar();
 }
 
 /* Private methods */
@@ -281,6 +339,47 @@ void TokenScanner::initScanner() {
     operators = nullptr;
 }
 
+/*
+ * Implementation notes: readChar, unreadChar, tokenText
+ * -----------------------------------------------------
+ * These methods hide the difference between the two input modes.  For
+ * a string, they move a cursor over the text and tokenText returns the
+ * slice between the start of the token and the cursor.  For a stream,
+ * the characters read so far are collected in scratch instead.
+ *
+ * In both modes, once a read has reached the end of the input every
+ * later read returns EOF and unreadChar has no effect, which is how
+ * an input stream behaves after its fail bit has been set.
+ */
+
+int TokenScanner::readChar() {
+    if (isp != nullptr) {
+        int ch = isp->get();
+        if (ch != EOF) scratch += char(ch);
+        return ch;
+    }
+    if (exhausted || cursor >= input.size()) {
+        exhausted = true;
+        return EOF;
+    }
+    return (unsigned char) input[cursor++];
+}
+
+void TokenScanner::unreadChar() {
+    if (isp != nullptr) {
+        if (isp->fail()) return;
+        isp->unget();
+        if (!scratch.empty()) scratch.pop_back();
+        return;
+    }
+    if (!exhausted && cursor > 0) cursor--;
+}
+
+std::string_view TokenScanner::tokenText(size_t start) {
+    if (isp != nullptr) return scratch;
+    return input.substr(start, cursor - start);
+}
+
 /*
  * Implementation notes: skipSpaces
  * --------------------------------
@@ -289,11 +388,17 @@ void TokenScanner::initScanner() {
  */
 
 void TokenScanner::skipSpaces() {
+    if (isp == nullptr) {
+        while (!exhausted && cursor < input.size() && isSpaceChar((unsigned char) input[cursor])) {
+            cursor++;
+        }
+        return;
+    }
     while (true) {
-        int ch = isp->get();
+        int ch = readChar();
         if (ch == EOF) return;
-        if (!isspace(ch)) {
-            isp->unget();
+        if (!isSpaceChar(ch)) {
+            unreadChar();
             return;
         }
     }
@@ -303,21 +408,26 @@ void TokenScanner::skipSpaces() {
  * Implementation notes: scanWord
  * ------------------------------
  * Reads characters until the scanner reaches the end of a sequence
- * of word characters.
+ * of word characters.  A string with no added word characters is
+ * scanned in place, without going through readChar.
  */
 
-std::string TokenScanner::scanWord() {
-    std::string token = "";
+void TokenScanner::scanWord() {
+    if (isp == nullptr && wordChars.empty()) {
+        while (cursor < input.size() && isAlnumChar((unsigned char) input[cursor])) {
+            cursor++;
+        }
+        exhausted = (cursor == input.size());
+        return;
+    }
     while (true) {
-        int ch = isp->get();
+        int ch = readChar();
         if (ch == EOF) break;
         if (!isWordCharacter(ch)) {
-            isp->unget();
+            unreadChar();
             break;
         }
-        token += char(ch);
     }
-    return token;
 }
 
 /*
@@ -328,14 +438,26 @@ std::string TokenScanner::scanWord() {
  * call a finite-state machine.  The program uses the variable
  * <code>state</code> to record the history of the process and
  * determine what characters would be legal at this point in time.
+ * A string input first tries the common case of a plain run of digits
+ * directly and only runs the machine when a fraction or an exponent
+ * follows.
  */
 
-std::string TokenScanner::scanNumber() {
-    std::string token = "";
+void TokenScanner::scanNumber() {
+    if (isp == nullptr) {
+        size_t end = cursor + 1;
+        while (end < input.size() && isdigit((unsigned char) input[end])) {
+            end++;
+        }
+        if (end == input.size() || (input[end] != '.' && input[end] != 'E' && input[end] != 'e')) {
+            cursor = end;
+            exhausted = (cursor == input.size());
+            return;
+        }
+    }
     NumberScannerState state = INITIAL_STATE;
     while (state != FINAL_STATE) {
-        int ch = isp->get();
-        int xch = 'e';
+        int ch = readChar();
         switch (state) {
             case INITIAL_STATE:
                 if (!isdigit(ch)) {
@@ -348,18 +470,16 @@ std::string TokenScanner::scanNumber() {
                     state = AFTER_DECIMAL_POINT;
                 } else if (ch == 'E' || ch == 'e') {
                     state = STARTING_EXPONENT;
-                    xch = ch;
                 } else if (!isdigit(ch)) {
-                    if (ch != EOF) isp->unget();
+                    if (ch != EOF) unreadChar();
                     state = FINAL_STATE;
                 }
                 break;
             case AFTER_DECIMAL_POINT:
                 if (ch == 'E' || ch == 'e') {
                     state = STARTING_EXPONENT;
-                    xch = ch;
                 } else if (!isdigit(ch)) {
-                    if (ch != EOF) isp->unget();
+                    if (ch != EOF) unreadChar();
                     state = FINAL_STATE;
                 }
                 break;
@@ -369,8 +489,8 @@ std::string TokenScanner::scanNumber() {
                 } else if (isdigit(ch)) {
                     state = SCANNING_EXPONENT;
                 } else {
-                    if (ch != EOF) isp->unget();
-                    isp->unget();
+                    if (ch != EOF) unreadChar();
+                    unreadChar();
                     state = FINAL_STATE;
                 }
                 break;
@@ -378,15 +498,15 @@ std::string TokenScanner::scanNumber() {
                 if (isdigit(ch)) {
                     state = SCANNING_EXPONENT;
                 } else {
-                    if (ch != EOF) isp->unget();
-                    isp->unget();
-                    isp->unget();
+                    if (ch != EOF) unreadChar();
+                    unreadChar();
+                    unreadChar();
                     state = FINAL_STATE;
                 }
                 break;
             case SCANNING_EXPONENT:
                 if (!isdigit(ch)) {
-                    if (ch != EOF) isp->unget();
+                    if (ch != EOF) unreadChar();
                     state = FINAL_STATE;
                 }
                 break;
@@ -394,55 +514,73 @@ std::string TokenScanner::scanNumber() {
                 state = FINAL_STATE;
                 break;
         }
-        if (state != FINAL_STATE) {
-            token += char(ch);
-        }
     }
-    return token;
 }
 
 /*
  * Implementation notes: scanString
  * --------------------------------
- * Reads and returns a quoted string from the scanner, continuing until
- * it scans the matching delimiter.  The scanner generates an error if
- * there is no closing quotation mark before the end of the input.
+ * Reads a quoted string from the scanner, continuing until it scans
+ * the matching delimiter.  The scanner generates an error if there is
+ * no closing quotation mark before the end of the input.
  */
 
-std::string TokenScanner::scanString() {
-    std::string token = "";
-    char delim = isp->get();
-    token += delim;
+void TokenScanner::scanString() {
+    int delim = readChar();
     bool escape = false;
     while (true) {
-        int ch = isp->get();
+        int ch = readChar();
         if (ch == EOF) error("TokenScanner found unterminated string");
         if (ch == delim && !escape) break;
         escape = (ch == '\\') && !escape;
-        token += ch;
     }
-    return token + delim;
 }
 
 /*
- * Implementation notes: isOperator, isOperatorPrefix
- * --------------------------------------------------
- * These methods search the list of operators and return true if the
- * specified operator is either in the list or a prefix of an operator
- * in the list, respectively.  This code could be made considerably more
- * efficient by implementing operators as a trie.
+ * Implementation notes: scanOperator
+ * ----------------------------------
+ * Called after the scanner has read the character ch, which does not
+ * start any other kind of token.  The method follows the operator trie
+ * for as long as the input continues some defined operator, and then
+ * gives back the characters beyond the longest complete operator seen
+ * on the way.  It returns the length of the operator token, which is
+ * 1 when no multicharacter operator matches.
  */
 
-bool TokenScanner::isOperator(std::string op) {
-    for (StringCell *cp = operators; cp != nullptr; cp = cp->link) {
-        if (op == cp->str) return true;
+int TokenScanner::scanOperator(int ch) {
+    if (operators == nullptr) return 1;
+    OperatorNode *node = operators->first[(unsigned char) ch];
+    int length = 1;
+    int longest = 1;
+    while (node != nullptr) {
+        ch = readChar();
+        if (ch == EOF) break;
+        node = findChild(node->children, ch);
+        if (node == nullptr) {
+            unreadChar();
+            break;
+        }
+        length++;
+        if (node->terminal) longest = length;
+    }
+    for (int i = longest; i < length; i++) {
+        unreadChar();
+    }
+    return longest;
+}
+
+TokenScanner::OperatorNode *TokenScanner::findChild(OperatorNode *node, char ch) {
+    while (node != nullptr && node->ch != ch) {
+        node = node->sibling;
     }
-    return false;
+    return node;
 }
 
-bool TokenScanner::isOperatorPrefix(std::string op) {
-    for (StringCell *cp = operators; cp != nullptr; cp = cp->link) {
-        if (startsWith(cp->str, op)) return true;
+void TokenScanner::freeOperators(OperatorNode *node) {
+    while (node != nullptr) {
+        OperatorNode *next = node->sibling;
+        freeOperators(node->children);
+        delete node;
+        node = next;
     }
-    return false;
 }
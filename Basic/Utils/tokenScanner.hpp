@@ -16,6 +16,7 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 
 /*
  * Type: TokenType
@@ -28,6 +29,19 @@ enum TokenType {
     SEPARATOR, WORD, NUMBER, STRING, OPERATOR
 };
 
+/*
+ * Type: TokenView
+ * ---------------
+ * A token returned by <code>nextTokenView</code>: the text of the token
+ * together with its type.  At the end of the input, <code>text</code>
+ * is empty and <code>type</code> is <code>TokenType(EOF)</code>.
+ */
+
+struct TokenView {
+    std::string_view text;
+    TokenType type;
+};
+
 /*
  * Class: TokenScanner
  * -------------------
@@ -85,10 +99,17 @@ public:
  * --------------------------------
  * Sets the token stream for this scanner to the specified string or
  * input stream.  Any previous token stream is discarded.
+ *
+ * A string is scanned in place with a cursor rather than through a
+ * stream.  The <code>std::string</code> version keeps its own copy of
+ * the text; the <code>std::string_view</code> version does not copy
+ * anything, so the caller must keep the text alive while scanning.
  */
 
     void setInput(std::string str);
 
+    void setInput(std::string_view str);
+
     void setInput(std::istream &infile);
 
 /*
@@ -111,6 +132,19 @@ public:
 
     std::string nextToken();
 
+/*
+ * Method: nextTokenView
+ * Usage: TokenView token = scanner.nextTokenView();
+ * -------------------------------------------------
+ * Returns the next token in the same way as <code>nextToken</code>,
+ * but without building a new string.  When the scanner reads from a
+ * string, the text of the token refers directly into that string.
+ * In every case the view is only guaranteed to stay valid until the
+ * next call that reads from the scanner.
+ */
+
+    TokenView nextTokenView();
+
 /*
  * Method: saveToken
  * Usage: scanner.saveToken(token);
@@ -121,7 +155,7 @@ public:
  * token stream.
  */
 
-    void saveToken(std::string token);
+    void saveToken(std::string_view token);
 
 /*
  * Method: getPosition
@@ -266,6 +300,8 @@ public:
 
     TokenType getTokenType(std::string token) const;
 
+    TokenType getTokenType(std::string_view token) const;
+
 /*
  * Method: getChar
  * Usage: int ch = scanner.getChar();
@@ -306,20 +342,37 @@ public:
 private:
 
 /*
- * Private type: StringCell
- * ------------------------
- * This type is used to construct linked lists of cells, which are used
- * to represent both the stack of saved tokens and the set of defined
- * operators.  These types cannot use the Stack and Lexicon classes
- * directly because tokenscanner.h is an extremely low-level interface,
- * and doing so would create circular dependencies in the .h files.
+ * Private type: OperatorNode
+ * --------------------------
+ * This type is used to build the trie of multicharacter operators.
+ * The root of the trie has a table indexed by the first character of
+ * an operator; below that, the children of a node are few, so they
+ * are kept in a linked list of siblings.  A node is terminal if the
+ * characters on the path to it spell a complete operator.
  */
 
-    struct StringCell {
-        std::string str;
-        StringCell *link;
+    struct OperatorNode {
+        char ch;
+        bool terminal;
+        OperatorNode *children;
+        OperatorNode *sibling;
+    };
+
+    struct OperatorTable {
+        OperatorNode *first[256];
     };
 
+/*
+ * Private constant: MAX_SAVED_TOKENS
+ * ----------------------------------
+ * The capacity of the lookahead buffer behind saveToken.  Saved tokens
+ * are kept in a fixed array of strings whose storage is reused from one
+ * token to the next, so peeking ahead does not touch the heap.  The
+ * parser never needs more than one token of lookahead.
+ */
+
+    static const int MAX_SAVED_TOKENS = 4;
+
     enum NumberScannerState {
         INITIAL_STATE,
         BEFORE_DECIMAL_POINT,
@@ -331,30 +384,43 @@ private:
     };
 
     std::string buffer;              /* The original argument string */
-    std::istream *isp = nullptr;     /* The input stream for tokens  */
+    std::string_view input;          /* The string being scanned     */
+    size_t cursor = 0;               /* Position of the next char    */
+    bool exhausted = false;          /* A read has hit the end       */
+    std::istream *isp = nullptr;     /* The input stream, if any     */
+    std::string scratch;             /* Text of stream/saved tokens  */
     bool ignoreWhitespaceFlag;       /* Scanner ignores whitespace   */
     bool ignoreCommentsFlag;         /* Scanner ignores comments     */
     bool scanNumbersFlag;            /* Scanner parses numbers       */
     bool scanStringsFlag;            /* Scanner parses strings       */
     std::string wordChars;           /* Additional word characters   */
-    StringCell *savedTokens = nullptr;         /* Stack of saved tokens        */
-    StringCell *operators = nullptr;           /* List of multichar operators  */
+    std::string savedTokens[MAX_SAVED_TOKENS]; /* Stack of saved tokens     */
+    int savedCount = 0;                        /* Number of saved tokens    */
+    OperatorTable *operators = nullptr;        /* Trie of multichar operators  */
 
 /* Private method prototypes */
 
     void initScanner();
 
+    int readChar();
+
+    void unreadChar();
+
+    std::string_view tokenText(size_t start);
+
     void skipSpaces();
 
-    std::string scanWord();
+    void scanWord();
+
+    void scanNumber();
 
-    std::string scanNumber();
+    void scanString();
 
-    std::string scanString();
+    int scanOperator(int ch);
 
-    bool isOperator(std::string op);
+    static OperatorNode *findChild(OperatorNode *node, char ch);
 
-    bool isOperatorPrefix(std::string op);
+    static void freeOperators(OperatorNode *node);
 
 };
 
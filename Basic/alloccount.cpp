@@ -0,0 +1,65 @@
+/*
+ * File: alloccount.cpp
+ * --------------------
+ * This file implements the allocation counter by replacing the global
+ * allocation functions.  All the replaceable forms of operator new
+ * funnel into countedAllocate, and every operator delete into free.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "alloccount.hpp"
+
+static std::atomic<long> allocationCount(0);
+
+long getAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+static void *countedAllocate(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new(size_t size) {
+    return countedAllocate(size);
+}
+
+void *operator new[](size_t size) {
+    return countedAllocate(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return countedAllocate(size);
+    } catch (std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return countedAllocate(size);
+    } catch (std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
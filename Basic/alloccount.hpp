@@ -0,0 +1,22 @@
+/*
+ * File: alloccount.h
+ * ------------------
+ * This interface exports the allocation counter of the diagnostic
+ * build.  It is only linked into the code-alloc target, which defines
+ * BASIC_COUNT_ALLOCS, and replaces the global operator new so that
+ * every heap allocation made by the interpreter is counted.
+ */
+
+#ifndef _alloccount_h
+#define _alloccount_h
+
+/*
+ * Function: getAllocationCount
+ * Usage: long n = getAllocationCount();
+ * -------------------------------------
+ * Returns the number of calls to operator new made so far.
+ */
+
+long getAllocationCount();
+
+#endif
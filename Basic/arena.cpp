@@ -0,0 +1,245 @@
+/*
+ * File: arena.cpp
+ * ---------------
+ * This file implements the NodeArena and ArenaScope classes.
+ */
+
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+#include "arena.hpp"
+
+/*
+ * Implementation notes: memory layout
+ * -----------------------------------
+ * The nodes of a block follow its Block header.  Every node is preceded
+ * by a Header naming the block it came from, or nullptr for a node on
+ * the heap, which is all deallocate needs to find its way back.  Blocks
+ * are kept on a doubly linked list so that a block can be taken out of
+ * the middle when its last node dies.
+ * Sizes are rounded to 16 bytes to keep every node suitably aligned.
+ */
+
+struct alignas(16) NodeArena::Block {
+    Block *prev;
+    Block *next;
+    NodeArena *owner;
+    size_t size;          /* Bytes available after the block header */
+    size_t used;          /* Bytes handed out so far                */
+    size_t live;          /* Nodes allocated and not yet freed      */
+};
+
+struct alignas(16) NodeArena::Header {
+    Block *block;
+};
+
+/*
+ * Implementation notes: block size
+ * --------------------------------
+ * A standard block fills one 2 MB huge page, of which the first 64
+ * bytes are kept for the Block header, and is allocated on that
+ * boundary.  Where the system supports it the block is marked for
+ * transparent huge pages, so loading a large program takes one page
+ * fault per block instead of one per 4 KB.  Blocks for oversized
+ * nodes come from the ordinary heap.
+ */
+
+static const size_t BLOCK_BYTES = 2 * 1024 * 1024;
+static const size_t BLOCK_SIZE = BLOCK_BYTES - 64;
+static const int MAX_SPARE_BLOCKS = 4;
+
+static size_t roundUp(size_t size) {
+    return (size + 15) & ~size_t(15);
+}
+
+thread_local NodeArena *NodeArena::currentArena = nullptr;
+
+NodeArena::NodeArena() : blocks(nullptr), active(nullptr), spare(nullptr) {}
+
+NodeArena::~NodeArena() {
+    reset();
+}
+
+void NodeArena::reset() {
+    freeList(blocks);
+    freeList(spare);
+    blocks = nullptr;
+    active = nullptr;
+    spare = nullptr;
+}
+
+void NodeArena::adopt(NodeArena &other) {
+    if (&other == this) return;
+    Block *block = other.blocks;
+    while (block != nullptr) {
+        Block *next = block->next;
+        link(block);
+        block = next;
+    }
+    Block *oldActive = other.active;
+    freeList(other.spare);
+    other.blocks = nullptr;
+    other.active = nullptr;
+    other.spare = nullptr;
+    if (oldActive != nullptr && oldActive->live == 0) release(oldActive);
+}
+
+int NodeArena::getBlockCount() {
+    int count = 0;
+    for (Block *block = blocks; block != nullptr; block = block->next) {
+        count++;
+    }
+    return count;
+}
+
+void *NodeArena::allocate(size_t size) {
+    if (currentArena != nullptr) return currentArena->allocateNode(size);
+    Header *header = (Header *) ::operator new(sizeof(Header) + size);
+    header->block = nullptr;
+    return header + 1;
+}
+
+void NodeArena::deallocate(void *ptr) {
+    if (ptr == nullptr) return;
+    Header *header = (Header *) ptr - 1;
+    Block *block = header->block;
+    if (block == nullptr) {
+        ::operator delete(header);
+        return;
+    }
+    block->live--;
+    if (block->live == 0 && block != block->owner->active) {
+        block->owner->release(block);
+    }
+}
+
+void *NodeArena::allocateBuffer(size_t size) {
+    return allocateNode(size);
+}
+
+NodeArena *NodeArena::current() {
+    return currentArena;
+}
+
+/*
+ * Implementation notes: allocateNode
+ * ----------------------------------
+ * Nodes are carved from the active block.  When it fills up, the next
+ * block comes from the spare list if possible.  An allocation larger
+ * than a whole block gets a block of its own and leaves the active
+ * block alone.
+ */
+
+void *NodeArena::allocateNode(size_t size) {
+    size_t need = roundUp(sizeof(Header) + size);
+    Block *block = active;
+    if (block == nullptr || block->used + need > block->size) {
+        if (need > BLOCK_SIZE) {
+            block = newBlock(need);
+            link(block);
+        } else {
+            if (spare != nullptr) {
+                block = spare;
+                spare = spare->next;
+                block->used = 0;
+                block->live = 0;
+            } else {
+                block = newBlock(BLOCK_SIZE);
+            }
+            link(block);
+            Block *old = active;
+            active = block;
+            if (old != nullptr && old->live == 0) release(old);
+        }
+    }
+    Header *header = (Header *) ((char *) (block + 1) + block->used);
+    block->used += need;
+    block->live++;
+    header->block = block;
+    return header + 1;
+}
+
+NodeArena::Block *NodeArena::newBlock(size_t size) {
+    static_assert(sizeof(Block) <= BLOCK_BYTES - BLOCK_SIZE, "Block header too large");
+    Block *block;
+    if (size == BLOCK_SIZE) {
+        block = (Block *) std::aligned_alloc(BLOCK_BYTES, BLOCK_BYTES);
+        if (block == nullptr) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+        madvise(block, BLOCK_BYTES, MADV_HUGEPAGE);
+#endif
+    } else {
+        block = (Block *) ::operator new(sizeof(Block) + size);
+    }
+    block->prev = nullptr;
+    block->next = nullptr;
+    block->owner = this;
+    block->size = size;
+    block->used = 0;
+    block->live = 0;
+    return block;
+}
+
+void NodeArena::link(Block *block) {
+    block->owner = this;
+    block->prev = nullptr;
+    block->next = blocks;
+    if (blocks != nullptr) blocks->prev = block;
+    blocks = block;
+}
+
+void NodeArena::unlink(Block *block) {
+    if (block->prev != nullptr) block->prev->next = block->next;
+    else blocks = block->next;
+    if (block->next != nullptr) block->next->prev = block->prev;
+    block->prev = nullptr;
+    block->next = nullptr;
+}
+
+/*
+ * Implementation notes: release
+ * -----------------------------
+ * A block whose nodes have all been freed goes back to the spare list
+ * if it has the standard size and the list is short, and to the heap
+ * otherwise.
+ */
+
+void NodeArena::release(Block *block) {
+    unlink(block);
+    if (block == active) active = nullptr;
+    int spares = 0;
+    for (Block *b = spare; b != nullptr; b = b->next) {
+        spares++;
+    }
+    if (block->size == BLOCK_SIZE && spares < MAX_SPARE_BLOCKS) {
+        block->next = spare;
+        spare = block;
+    } else {
+        freeBlock(block);
+    }
+}
+
+void NodeArena::freeList(Block *list) {
+    while (list != nullptr) {
+        Block *next = list->next;
+        freeBlock(list);
+        list = next;
+    }
+}
+
+void NodeArena::freeBlock(Block *block) {
+    if (block->size == BLOCK_SIZE) {
+        std::free(block);
+    } else {
+        ::operator delete(block);
+    }
+}
+
+ArenaScope::ArenaScope(NodeArena &arena) {
+    saved = NodeArena::currentArena;
+    NodeArena::currentArena = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+    NodeArena::currentArena = saved;
+}
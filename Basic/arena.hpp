@@ -0,0 +1,187 @@
+/*
+ * File: arena.h
+ * -------------
+ * This interface exports the NodeArena class, a bump allocator for the
+ * expression and statement nodes of a parsed program.
+ */
+
+#ifndef _arena_h
+#define _arena_h
+
+#include <cstddef>
+
+/*
+ * Class: NodeArena
+ * ----------------
+ * A NodeArena hands out memory from large blocks by advancing a
+ * pointer, so the nodes of one line end up next to each other and
+ * allocating a node costs a few instructions instead of a call to the
+ * general-purpose heap.
+ *
+ * Each block counts the nodes that are still alive in it.  When a
+ * line is replaced or removed, its nodes are deleted as usual; once
+ * every node in a block is gone, the block is recycled for later
+ * lines, so editing a program does not leak.  Destroying the arena,
+ * or calling reset, releases all blocks at once.
+ *
+ * The Expression and Statement classes route their operator new and
+ * operator delete through allocate and deallocate.  Nodes go into the
+ * arena made current on this thread by an ArenaScope, or onto the
+ * ordinary heap when no arena is current.
+ */
+
+class NodeArena {
+
+public:
+
+/*
+ * Constructor: NodeArena
+ * Usage: NodeArena arena;
+ * -----------------------
+ * Creates an empty arena.  No memory is allocated until the first
+ * node is.
+ */
+
+    NodeArena();
+
+/*
+ * Destructor: ~NodeArena
+ * Usage: usually implicit
+ * -----------------------
+ * Releases every block owned by the arena.  Any node still living in
+ * the arena must not be used or deleted afterwards.
+ */
+
+    ~NodeArena();
+
+    NodeArena(const NodeArena &) = delete;
+
+    NodeArena &operator=(const NodeArena &) = delete;
+
+/*
+ * Method: reset
+ * Usage: arena.reset();
+ * ---------------------
+ * Releases every block at once, leaving the arena empty.  As with the
+ * destructor, the nodes in the arena must already be dead.
+ */
+
+    void reset();
+
+/*
+ * Method: adopt
+ * Usage: arena.adopt(other);
+ * --------------------------
+ * Moves every block of other into this arena, leaving other empty.
+ * The nodes in those blocks stay where they are and are afterwards
+ * accounted to this arena.
+ */
+
+    void adopt(NodeArena &other);
+
+/*
+ * Method: getBlockCount
+ * Usage: int n = arena.getBlockCount();
+ * -------------------------------------
+ * Returns the number of blocks that currently hold live nodes.
+ */
+
+    int getBlockCount();
+
+/*
+ * Functions: allocate, deallocate
+ * Usage: void *p = NodeArena::allocate(size);
+ *        NodeArena::deallocate(p);
+ * -------------------------------------------
+ * Allocate memory for a node from the current arena of this thread,
+ * or from the heap if there is none, and give it back.  deallocate
+ * works out on its own where the memory came from.
+ */
+
+    static void *allocate(size_t size);
+
+    static void deallocate(void *ptr);
+
+/*
+ * Method: allocateBuffer
+ * Usage: char *text = (char *) arena.allocateBuffer(size);
+ * --------------------------------------------------------
+ * Allocates raw storage from this arena, whichever arena is current.
+ * The storage is given back with NodeArena::deallocate like a node.
+ */
+
+    void *allocateBuffer(size_t size);
+
+/*
+ * Function: current
+ * Usage: NodeArena *arena = NodeArena::current();
+ * -----------------------------------------------
+ * Returns the arena that new nodes on this thread are allocated from,
+ * or nullptr if nodes currently go to the heap.
+ */
+
+    static NodeArena *current();
+
+private:
+
+    struct Block;
+
+    struct Header;
+
+    Block *blocks;        /* Blocks that hold live nodes      */
+    Block *active;        /* Block that new nodes go into     */
+    Block *spare;         /* Recycled blocks, ready for reuse */
+
+    void *allocateNode(size_t size);
+
+    Block *newBlock(size_t size);
+
+    void link(Block *block);
+
+    void unlink(Block *block);
+
+    void release(Block *block);
+
+    static void freeList(Block *list);
+
+    static void freeBlock(Block *block);
+
+    friend class ArenaScope;
+
+    static thread_local NodeArena *currentArena;
+
+};
+
+/*
+ * Class: ArenaScope
+ * -----------------
+ * Makes an arena current on this thread for the lifetime of the
+ * scope object, restoring the previous one when it goes away:
+ *
+ *<pre>
+ *    {
+ *       ArenaScope scope(program.getArena());
+ *       ... nodes created here live in the program's arena ...
+ *    }
+ *</pre>
+ */
+
+class ArenaScope {
+
+public:
+
+    explicit ArenaScope(NodeArena &arena);
+
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope &) = delete;
+
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+private:
+
+    NodeArena *saved;
+
+};
+
+#endif
@@ -0,0 +1,227 @@
+/*
+ * File: bytecode.cpp
+ * ------------------
+ * This file implements the ExpCode class.
+ */
+
+#include <algorithm>
+#include "bytecode.hpp"
+#include "keyword.hpp"
+#include "output.hpp"
+#include "Utils/error.hpp"
+
+ExpCode::ExpCode() = default;
+
+/*
+ * Implementation notes: countNodes
+ * --------------------------------
+ * The count is the number of instructions compile emits for the tree
+ * apart from the final OP_RETURN, or fewer for a malformed assignment.
+ */
+
+int countNodes(Expression *exp) {
+    if (exp == nullptr) return 0;
+    if (exp->getType() != COMPOUND) return 1;
+    CompoundExp *compound = (CompoundExp *) exp;
+    return 1 + countNodes(compound->getLHS()) + countNodes(compound->getRHS());
+}
+
+/*
+ * Constants: FAIL_ASSIGNMENT, FAIL_SYNTAX
+ * ---------------------------------------
+ * The operands of OP_FAIL, which index FAIL_MESSAGES.  The messages
+ * are fixed, so compiling an expression never has to copy one.
+ */
+
+enum { FAIL_ASSIGNMENT, FAIL_SYNTAX };
+
+static const char *const FAIL_MESSAGES[] = {
+    "Illegal variable in assignment", "SYNTAX ERROR"
+};
+
+/*
+ * Implementation notes: compile
+ * -----------------------------
+ * The tree is flattened in postfix order, which evaluates the left
+ * operand before the right one exactly as CompoundExp::eval does.  The
+ * checks that CompoundExp::eval makes on an assignment only depend on
+ * the shape of the tree, so they are decided here and turned into an
+ * OP_FAIL instruction when they would fail at run time.
+ */
+
+void ExpCode::compile(Expression *exp) {
+    code.clear();
+    code.reserve(countNodes(exp) + 1);
+    int depth = compileNode(exp, 0);
+    emit(OP_RETURN, 0, 0);
+    stack.assign(std::max(depth, 1), 0);
+}
+
+/*
+ * Implementation notes: reserve
+ * -----------------------------
+ * The stack never grows deeper than the tree has nodes, so the node
+ * count bounds both arrays.
+ */
+
+void ExpCode::reserve(Expression *exp) {
+    int nodes = countNodes(exp);
+    code.reserve(nodes + 1);
+    stack.reserve(nodes);
+}
+
+int ExpCode::compileNode(Expression *exp, int depth) {
+    switch (exp->getType()) {
+        case CONSTANT:
+            return emit(OP_CONST, ((ConstantExp *) exp)->getValue(), depth + 1);
+        case IDENTIFIER:
+            return emit(OP_LOAD, ((IdentifierExp *) exp)->getSlot(), depth + 1);
+        case COMPOUND:
+            break;
+    }
+    CompoundExp *compound = (CompoundExp *) exp;
+    TokenKind op = classifyToken(compound->getOp());
+    Expression *lhs = compound->getLHS();
+    Expression *rhs = compound->getRHS();
+    if (op == TOK_EQUALS) {
+        if (lhs->getType() != IDENTIFIER) {
+            return emit(OP_FAIL, FAIL_ASSIGNMENT, depth + 1);
+        }
+        if (((IdentifierExp *) lhs)->getName() == "LET") {
+            return emit(OP_FAIL, FAIL_SYNTAX, depth + 1);
+        }
+        int maxDepth = compileNode(rhs, depth);
+        emit(OP_STORE, ((IdentifierExp *) lhs)->getSlot(), depth + 1);
+        return maxDepth;
+    }
+    int leftDepth = compileNode(lhs, depth);
+    int rightDepth = compileNode(rhs, depth + 1);
+    OpCode opcode = OP_ADD;
+    switch (op) {
+        case TOK_PLUS: opcode = OP_ADD; break;
+        case TOK_MINUS: opcode = OP_SUB; break;
+        case TOK_TIMES: opcode = OP_MUL; break;
+        case TOK_DIVIDE: opcode = OP_DIV; break;
+        default: error("Illegal operator in expression");
+    }
+    emit(opcode, 0, depth + 1);
+    return std::max(leftDepth, rightDepth);
+}
+
+int ExpCode::emit(OpCode op, int operand, int depth) {
+    code.push_back({op, operand});
+    return depth;
+}
+
+bool ExpCode::isEmpty() {
+    return code.empty();
+}
+
+const Instruction *ExpCode::getInstructions() {
+    return code.data();
+}
+
+/*
+ * Implementation notes: eval
+ * --------------------------
+ * The operand stack is preallocated by compile, so evaluation performs
+ * no allocation unless it reports an error.
+ */
+
+int ExpCode::eval(EvalState &state) {
+    return runCode(code.data(), stack.data(), state);
+}
+
+/*
+ * Implementation notes: runCode
+ * -----------------------------
+ * The variables are reached through the slot array directly, which
+ * cannot move while instructions run, since that only happens when a
+ * new variable is given a slot.  OP_LOOP is followed by the increment
+ * of the loop, so it stops one instruction short of its target.
+ */
+
+int runCode(const Instruction *code, int *stack, EvalState &state) {
+    EvalState::Slot *slots = state.getSlots();
+    int *sp = stack;
+    for (const Instruction *ip = code; ; ip++) {
+        switch (ip->op) {
+            case OP_CONST:
+                *sp++ = ip->operand;
+                break;
+            case OP_LOAD:
+                if (!slots[ip->operand].defined) error("VARIABLE NOT DEFINED");
+                *sp++ = slots[ip->operand].value;
+                break;
+            case OP_STORE:
+                slots[ip->operand] = {sp[-1], true};
+                break;
+            case OP_ADD:
+                sp--;
+                sp[-1] = sp[-1] + sp[0];
+                break;
+            case OP_SUB:
+                sp--;
+                sp[-1] = sp[-1] - sp[0];
+                break;
+            case OP_MUL:
+                sp--;
+                sp[-1] = sp[-1] * sp[0];
+                break;
+            case OP_DIV:
+                sp--;
+                if (sp[0] == 0) error("DIVIDE BY ZERO");
+                sp[-1] = sp[-1] / sp[0];
+                break;
+            case OP_FAIL:
+                error(FAIL_MESSAGES[ip->operand]);
+                break;
+            case OP_RETURN:
+                return sp[-1];
+            case OP_FETCH:
+                *sp++ = slots[ip->operand].value;
+                break;
+            case OP_DEFINED:
+                *sp++ = slots[ip->operand].defined;
+                break;
+            case OP_SET:
+                slots[ip->operand] = {*--sp, true};
+                break;
+            case OP_PRINT: {
+                OutputSink &out = standardOutput();
+                out.writeInt(*--sp);
+                out.endLine();
+                break;
+            }
+            case OP_EXIT_EQ:
+                sp -= 2;
+                if (sp[0] == sp[1]) return ip->operand;
+                break;
+            case OP_EXIT_NE:
+                sp -= 2;
+                if (sp[0] != sp[1]) return ip->operand;
+                break;
+            case OP_EXIT_LT:
+                sp -= 2;
+                if (sp[0] < sp[1]) return ip->operand;
+                break;
+            case OP_EXIT_GE:
+                sp -= 2;
+                if (sp[0] >= sp[1]) return ip->operand;
+                break;
+            case OP_EXIT_GT:
+                sp -= 2;
+                if (sp[0] > sp[1]) return ip->operand;
+                break;
+            case OP_EXIT_LE:
+                sp -= 2;
+                if (sp[0] <= sp[1]) return ip->operand;
+                break;
+            case OP_JUMP:
+                return ip->operand;
+            case OP_LOOP:
+                ip -= ip->operand + 1;
+                break;
+        }
+    }
+}
@@ -0,0 +1,168 @@
+/*
+ * File: bytecode.h
+ * ----------------
+ * This interface exports the ExpCode class, which holds an expression
+ * tree compiled into a flat postfix instruction array.  Evaluating the
+ * compiled form is a single loop over the instructions with an integer
+ * operand stack, instead of a recursive walk through the tree.
+ */
+
+#ifndef _bytecode_h
+#define _bytecode_h
+
+#include <vector>
+#include "exp.hpp"
+#include "evalstate.hpp"
+
+/*
+ * Type: OpCode
+ * ------------
+ * The instruction set of the expression machine.  Operands live in
+ * the instruction itself:
+ *
+ *   OP_CONST  -- push the constant operand
+ *   OP_LOAD   -- push the variable in slot operand
+ *   OP_STORE  -- assign the top of the stack to slot operand,
+ *                leaving the value on the stack
+ *   OP_ADD, OP_SUB, OP_MUL, OP_DIV
+ *             -- pop two values and push the result
+ *   OP_FAIL   -- raise the error numbered operand, one of the fixed
+ *                messages of a malformed assignment
+ *   OP_RETURN -- return the top of the stack
+ *
+ * The traces and blocks of TraceCache are built from the instructions
+ * of the statements' expressions and run on the same machine, with
+ * these further instructions, which an expression never contains:
+ *
+ *   OP_FETCH   -- push the variable in slot operand, which is known
+ *                 to be defined
+ *   OP_DEFINED -- push 1 if the variable in slot operand is defined,
+ *                 0 if it is not
+ *   OP_SET     -- pop a value and assign it to slot operand
+ *   OP_PRINT   -- pop a value and print it on a line of its own
+ *   OP_EXIT_EQ, OP_EXIT_NE, OP_EXIT_LT, OP_EXIT_GE, OP_EXIT_GT, OP_EXIT_LE
+ *              -- pop two values and return operand if they compare
+ *                 that way
+ *   OP_JUMP    -- return operand
+ *   OP_LOOP    -- continue operand instructions back
+ */
+
+enum OpCode {
+    OP_CONST, OP_LOAD, OP_STORE, OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_FAIL, OP_RETURN,
+    OP_FETCH, OP_DEFINED, OP_SET, OP_PRINT,
+    OP_EXIT_EQ, OP_EXIT_NE, OP_EXIT_LT, OP_EXIT_GE, OP_EXIT_GT, OP_EXIT_LE,
+    OP_JUMP, OP_LOOP
+};
+
+struct Instruction {
+    OpCode op;
+    int operand;
+};
+
+/*
+ * Function: runCode
+ * Usage: int result = runCode(code, stack, state);
+ * ------------------------------------------------
+ * Runs instructions from code until one of them returns, using stack
+ * as the operand stack, which must be deep enough for them.  Returns
+ * the value of the expression for OP_RETURN and the operand for the
+ * exits and jumps of a trace.  Every error of an expression is raised
+ * here, exactly where Expression::eval would raise it.
+ */
+
+int runCode(const Instruction *code, int *stack, EvalState &state);
+
+/*
+ * Function: countNodes
+ * Usage: int nodes = countNodes(exp);
+ * -----------------------------------
+ * Returns the number of nodes in the tree, or 0 for no tree.  This
+ * bounds both the number of instructions compiled for it and the
+ * depth of the stack they need.
+ */
+
+int countNodes(Expression *exp);
+
+/*
+ * Class: ExpCode
+ * --------------
+ * The compiled form of one expression.  An ExpCode reports the same
+ * errors as Expression::eval, in the same order.
+ */
+
+class ExpCode {
+
+public:
+
+/*
+ * Constructor: ExpCode
+ * Usage: ExpCode code;
+ * --------------------
+ * Creates an empty code object.  It must be compiled before use.
+ */
+
+    ExpCode();
+
+/*
+ * Method: compile
+ * Usage: code.compile(exp);
+ * -------------------------
+ * Translates the expression tree into postfix instructions, replacing
+ * any previous contents.  The tree must already have been passed to
+ * resolveVariables; it is not modified or retained.
+ */
+
+    void compile(Expression *exp);
+
+/*
+ * Method: reserve
+ * Usage: code.reserve(exp);
+ * -------------------------
+ * Allocates all the room that compiling the expression will need
+ * without compiling it, so that a later call to compile performs no
+ * allocation.
+ */
+
+    void reserve(Expression *exp);
+
+/*
+ * Method: eval
+ * Usage: int value = code.eval(state);
+ * ------------------------------------
+ * Runs the instructions and returns the value of the expression.
+ */
+
+    int eval(EvalState &state);
+
+/*
+ * Method: isEmpty
+ * Usage: if (code.isEmpty()) ...
+ * ------------------------------
+ * Returns true if nothing has been compiled yet.
+ */
+
+    bool isEmpty();
+
+/*
+ * Method: getInstructions
+ * Usage: const Instruction *ip = code.getInstructions();
+ * ------------------------------------------------------
+ * Returns the compiled instructions, which end with OP_RETURN.  The
+ * pointer stays valid until the code is compiled again.
+ */
+
+    const Instruction *getInstructions();
+
+private:
+
+    std::vector<Instruction> code;
+
+    std::vector<int> stack;             /* Sized to the deepest push   */
+
+    int emit(OpCode op, int operand, int depth);
+
+    int compileNode(Expression *exp, int depth);
+
+};
+
+#endif
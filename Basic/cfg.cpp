@@ -0,0 +1,94 @@
+/*
+ * File: cfg.cpp
+ * -------------
+ * This file implements the ControlFlowGraph class.
+ */
+
+#include <string>
+#include "cfg.hpp"
+#include "program.hpp"
+
+ControlFlowGraph::ControlFlowGraph() = default;
+
+/*
+ * Implementation notes: build
+ * ---------------------------
+ * The first pass marks the records that start a block, the second
+ * cuts the image at the marks.  A GOTO to a missing line reports the
+ * error and carries on, so it falls through instead of jumping.
+ */
+
+void ControlFlowGraph::build(const StatementRecord *image, int size) {
+    blocks.clear();
+    blockOf.assign(size, 0);
+    std::vector<bool> leader(size + 1, false);
+    leader[0] = true;
+    for (int i = 0; i < size; i++) {
+        const StatementRecord &rec = image[i];
+        if (rec.opcode == STMT_GOTO || rec.opcode == STMT_IF || rec.opcode == STMT_END) {
+            leader[i + 1] = true;
+            if (rec.target >= 0) leader[rec.target] = true;
+        }
+    }
+    for (int i = 0; i < size; i++) {
+        if (leader[i]) blocks.push_back({i, i, -1, true});
+        BasicBlock &block = blocks.back();
+        block.end = i + 1;
+        blockOf[i] = blocks.size() - 1;
+        const StatementRecord &rec = image[i];
+        switch (rec.opcode) {
+            case STMT_GOTO:
+                block.jump = rec.target;
+                block.fallsThrough = (rec.target < 0);
+                break;
+            case STMT_IF:
+                block.jump = rec.target;
+                break;
+            case STMT_END:
+                block.fallsThrough = false;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+int ControlFlowGraph::getBlockCount() {
+    return blocks.size();
+}
+
+const BasicBlock &ControlFlowGraph::getBlock(int i) {
+    return blocks[i];
+}
+
+int ControlFlowGraph::findBlock(int index) {
+    return blockOf[index];
+}
+
+/*
+ * Implementation notes: dump
+ * --------------------------
+ * Control that runs past the last record, or jumps to a line after
+ * it, reaches the sentinel, which is shown as END like the END
+ * statement itself.
+ */
+
+void ControlFlowGraph::dump(Program &program, std::ostream &out) {
+    int size = blockOf.size();
+    auto successor = [&](int index) {
+        if (index >= size) return std::string("END");
+        return "B" + std::to_string(blockOf[index]);
+    };
+    for (size_t i = 0; i < blocks.size(); i++) {
+        const BasicBlock &block = blocks[i];
+        int firstLine = program.getImageLineNumber(block.first);
+        int lastLine = program.getImageLineNumber(block.end - 1);
+        out << 'B' << i << ' ' << firstLine;
+        if (lastLine != firstLine) out << '-' << lastLine;
+        out << " ->";
+        if (block.jump >= 0) out << ' ' << successor(block.jump);
+        if (block.fallsThrough) out << (block.jump >= 0 ? ", " : " ") << successor(block.end);
+        if (block.jump < 0 && !block.fallsThrough) out << " END";
+        out << '\n';
+    }
+}
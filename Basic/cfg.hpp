@@ -0,0 +1,114 @@
+/*
+ * File: cfg.h
+ * -----------
+ * This interface exports the ControlFlowGraph class, which divides a
+ * linked program image into basic blocks.
+ */
+
+#ifndef _cfg_h
+#define _cfg_h
+
+#include <ostream>
+#include <vector>
+#include "statement.hpp"
+
+class Program;
+
+/*
+ * Type: BasicBlock
+ * ----------------
+ * A run of image records that is only ever entered at its first record
+ * and only leaves at its last one.  A block ends with a GOTO, IF or
+ * END statement, or just before the target of some jump.
+ */
+
+struct BasicBlock {
+    int first;            /* Image index of the first record        */
+    int end;              /* Image index just past the last record  */
+    int jump;             /* Image index the last record may jump   */
+                          /* to, -1 if it does not jump             */
+    bool fallsThrough;    /* Control may go on to record end        */
+};
+
+/*
+ * Class: ControlFlowGraph
+ * -----------------------
+ * The basic blocks of one program image.  A block starts at the first
+ * record, at the target of every GOTO and IF, and after every GOTO, IF
+ * and END; its successors are the block at its jump target and the
+ * block that follows it.  runImage runs a hot block as one piece of
+ * straight-line code that only decides where to go once it reaches
+ * the end of the block.
+ */
+
+class ControlFlowGraph {
+
+public:
+
+/*
+ * Constructor: ControlFlowGraph
+ * Usage: ControlFlowGraph graph;
+ * ------------------------------
+ * Creates a graph with no blocks.
+ */
+
+    ControlFlowGraph();
+
+/*
+ * Method: build
+ * Usage: graph.build(image, size);
+ * --------------------------------
+ * Replaces the graph with the blocks of the first size records of
+ * image.  The STMT_HALT sentinel is not part of any block.
+ */
+
+    void build(const StatementRecord *image, int size);
+
+/*
+ * Method: getBlockCount
+ * Usage: int n = graph.getBlockCount();
+ * -------------------------------------
+ * Returns the number of blocks, which are numbered in image order.
+ */
+
+    int getBlockCount();
+
+/*
+ * Method: getBlock
+ * Usage: const BasicBlock &block = graph.getBlock(i);
+ * ---------------------------------------------------
+ * Returns block number i.
+ */
+
+    const BasicBlock &getBlock(int i);
+
+/*
+ * Method: findBlock
+ * Usage: int i = graph.findBlock(index);
+ * --------------------------------------
+ * Returns the number of the block that holds the record at the given
+ * image index.
+ */
+
+    int findBlock(int index);
+
+/*
+ * Method: dump
+ * Usage: graph.dump(program, out);
+ * --------------------------------
+ * Writes the blocks to out, one per line, with the line numbers they
+ * span and the blocks control can go to from each.  END stands for
+ * the end of the program.
+ */
+
+    void dump(Program &program, std::ostream &out);
+
+private:
+
+    std::vector<BasicBlock> blocks;
+
+    std::vector<int> blockOf;   /* Block number of every record */
+
+};
+
+#endif
@@ -0,0 +1,374 @@
+/*
+ * File: compiler.cpp
+ * ------------------
+ * This file implements the COMPILE command.
+ */
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <spawn.h>
+#include <sys/wait.h>
+#include "compiler.hpp"
+#include "exp.hpp"
+#include "keyword.hpp"
+#include "output.hpp"
+#include "Utils/error.hpp"
+
+extern char **environ;
+
+/*
+ * Constant: PRELUDE
+ * -----------------
+ * The start of every generated program.  The helpers reproduce the
+ * output of the interpreter: fail prints an error the way RUN reports
+ * it, which also ends the run, and readNumber is INPUT, including its
+ * prompt, its rule that the whole line is the number and its INVALID
+ * NUMBER retries.
+ * Arithmetic goes through unsigned values so that it wraps around
+ * exactly as the interpreter does on the same machine.
+ */
+
+static const char *const PRELUDE = R"(#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+#define ADD(a, b) ((int) ((unsigned) (a) + (unsigned) (b)))
+#define SUB(a, b) ((int) ((unsigned) (a) - (unsigned) (b)))
+#define MUL(a, b) ((int) ((unsigned) (a) * (unsigned) (b)))
+
+static char outputBuffer[1 << 16];
+
+_Noreturn static void fail(const char *message) {
+    puts(message);
+    exit(0);
+}
+
+static void lineNumberError(void) {
+    puts("LINE NUMBER ERROR");
+}
+
+static int parseNumber(const char *p, const char *end, int *value) {
+    int negative = 0;
+    long long n = 0;
+    if (p < end && *p == '-') {
+        negative = 1;
+        p++;
+    }
+    if (p == end) return 0;
+    for (; p < end; p++) {
+        if (*p < '0' || *p > '9') return 0;
+        if (n <= 2147483648LL) n = n * 10 + (*p - '0');
+    }
+    if (negative) n = -n;
+    if (n < -2147483647LL - 1 || n > 2147483647LL) return 0;
+    *value = (int) n;
+    return 1;
+}
+
+static int readNumber(void) {
+    static char *line = NULL;
+    static size_t capacity = 0;
+    for (;;) {
+        fputs(" ? ", stdout);
+        fflush(stdout);
+        ssize_t n = getline(&line, &capacity, stdin);
+        if (n < 0) exit(0);
+        if (n > 0 && line[n - 1] == '\n') n--;
+        int value;
+        if (parseNumber(line, line + n, &value)) return value;
+        puts("INVALID NUMBER");
+    }
+}
+
+)";
+
+/*
+ * Class: SourceWriter
+ * -------------------
+ * Writes the body of main.  Each statement is a block of its own, so
+ * that the temporaries holding intermediate values can be declared
+ * where they are computed.  An expression is written as one temporary
+ * per operation, in the order the interpreter evaluates the tree,
+ * because C leaves the order of evaluation of operands open and an
+ * expression may assign to a variable or raise an error part way.
+ */
+
+class SourceWriter {
+
+public:
+
+    SourceWriter(Program &program, std::ostream &out) : program(program), out(out), temps(0) {}
+
+    void write(EvalState &state);
+
+private:
+
+    Program &program;
+
+    std::ostream &out;
+
+    int temps;
+
+    std::map<int, std::string> names;   /* Variables by slot, "" if unnamed */
+
+    std::string newTemp();
+
+    std::string label(int index);
+
+    void collect(Expression *exp);
+
+    std::string expression(Expression *exp);
+
+    void statement(const StatementRecord &rec, int index);
+
+};
+
+/*
+ * Function: literal
+ * -----------------
+ * Returns a C expression for the integer.  The most negative int has
+ * no literal of its own in C.
+ */
+
+static std::string literal(int value) {
+    if (value == INT_MIN) return "(-2147483647 - 1)";
+    return std::to_string(value);
+}
+
+/*
+ * Function: comment
+ * -----------------
+ * Returns the text as a C comment, breaking up anything that would
+ * end the comment early.
+ */
+
+static std::string comment(const std::string &text) {
+    std::string result = "/* ";
+    for (size_t i = 0; i < text.size(); i++) {
+        result += text[i];
+        if (text[i] == '*' && i + 1 < text.size() && text[i + 1] == '/') result += ' ';
+    }
+    return result + " */";
+}
+
+std::string SourceWriter::newTemp() {
+    return "t" + std::to_string(temps++);
+}
+
+std::string SourceWriter::label(int index) {
+    if (index >= program.getImageSize()) return "program_end";
+    return "line_" + std::to_string(program.getImageLineNumber(index));
+}
+
+void SourceWriter::collect(Expression *exp) {
+    if (exp == nullptr) return;
+    if (exp->getType() == IDENTIFIER) {
+        IdentifierExp *var = (IdentifierExp *) exp;
+        if (var->getSlot() >= 0) names[var->getSlot()] = var->getName();
+    } else if (exp->getType() == COMPOUND) {
+        collect(((CompoundExp *) exp)->getLHS());
+        collect(((CompoundExp *) exp)->getRHS());
+    }
+}
+
+/*
+ * Implementation notes: expression
+ * --------------------------------
+ * Writes the statements that compute the expression and returns the
+ * C operand holding its value.  A variable is always copied into a
+ * temporary, since a later part of the expression may assign to it.
+ * After a call to fail the operand is never used, but one is returned
+ * anyway to keep the generated code well formed.
+ */
+
+std::string SourceWriter::expression(Expression *exp) {
+    switch (exp->getType()) {
+        case CONSTANT:
+            return literal(((ConstantExp *) exp)->getValue());
+        case IDENTIFIER: {
+            int slot = ((IdentifierExp *) exp)->getSlot();
+            std::string temp = newTemp();
+            out << "        if (!d" << slot << ") fail(\"VARIABLE NOT DEFINED\");\n";
+            out << "        int " << temp << " = v" << slot << ";\n";
+            return temp;
+        }
+        case COMPOUND:
+            break;
+    }
+    CompoundExp *compound = (CompoundExp *) exp;
+    TokenKind op = classifyToken(compound->getOp());
+    if (op == TOK_EQUALS) {
+        Expression *lhs = compound->getLHS();
+        if (lhs->getType() != IDENTIFIER) {
+            out << "        fail(\"Illegal variable in assignment\");\n";
+            return "0";
+        }
+        IdentifierExp *var = (IdentifierExp *) lhs;
+        if (var->getName() == "LET") {
+            out << "        fail(\"SYNTAX ERROR\");\n";
+            return "0";
+        }
+        std::string value = expression(compound->getRHS());
+        out << "        v" << var->getSlot() << " = " << value << ";\n";
+        out << "        d" << var->getSlot() << " = 1;\n";
+        return value;
+    }
+    std::string left = expression(compound->getLHS());
+    std::string right = expression(compound->getRHS());
+    std::string temp = newTemp();
+    switch (op) {
+        case TOK_PLUS:
+            out << "        int " << temp << " = ADD(" << left << ", " << right << ");\n";
+            break;
+        case TOK_MINUS:
+            out << "        int " << temp << " = SUB(" << left << ", " << right << ");\n";
+            break;
+        case TOK_TIMES:
+            out << "        int " << temp << " = MUL(" << left << ", " << right << ");\n";
+            break;
+        case TOK_DIVIDE:
+            if (right == "0") {
+                out << "        fail(\"DIVIDE BY ZERO\");\n";
+                return "0";
+            }
+            out << "        if (" << right << " == 0) fail(\"DIVIDE BY ZERO\");\n";
+            out << "        int " << temp << " = " << left << " / " << right << ";\n";
+            break;
+        default:
+            out << "        int " << temp << " = 0;\n";
+            break;
+    }
+    return temp;
+}
+
+void SourceWriter::statement(const StatementRecord &rec, int index) {
+    int lineNumber = program.getImageLineNumber(index);
+    out << label(index) << ":  " << comment(program.getSourceLine(lineNumber)) << "\n";
+    out << "    {\n";
+    temps = 0;
+    switch (rec.opcode) {
+        case STMT_LET: {
+            std::string value = expression(rec.lhs);
+            out << "        v" << rec.slot << " = " << value << ";\n";
+            out << "        d" << rec.slot << " = 1;\n";
+            break;
+        }
+        case STMT_PRINT: {
+            std::string value = expression(rec.lhs);
+            out << "        printf(\"%d\\n\", " << value << ");\n";
+            break;
+        }
+        case STMT_INPUT:
+            out << "        v" << rec.slot << " = readNumber();\n";
+            out << "        d" << rec.slot << " = 1;\n";
+            break;
+        case STMT_GOTO:
+            if (rec.target >= 0) {
+                out << "        goto " << label(rec.target) << ";\n";
+            } else {
+                out << "        lineNumberError();\n";
+            }
+            break;
+        case STMT_IF: {
+            std::string left = expression(rec.lhs);
+            std::string right = expression(rec.rhs);
+            const char *op = (rec.op == '=') ? "==" : (rec.op == '<') ? "<" : (rec.op == '>') ? ">" : nullptr;
+            if (op == nullptr) break;
+            out << "        if (" << left << " " << op << " " << right << ") ";
+            if (rec.target >= 0) {
+                out << "goto " << label(rec.target) << ";\n";
+            } else {
+                out << "lineNumberError();\n";
+            }
+            break;
+        }
+        case STMT_END:
+            out << "        return 0;\n";
+            break;
+        default:
+            break;
+    }
+    out << "    }\n";
+}
+
+/*
+ * Implementation notes: write
+ * ---------------------------
+ * The slots used by the program are found first, so that only those
+ * variables are declared.  The sentinel record of the image becomes
+ * the label program_end, where control arrives when it runs off the
+ * last line.
+ */
+
+void SourceWriter::write(EvalState &state) {
+    const StatementRecord *image = program.getImage();
+    int size = program.getImageSize();
+    for (int i = 0; i < size; i++) {
+        collect(image[i].lhs);
+        collect(image[i].rhs);
+        if (image[i].opcode == STMT_LET || image[i].opcode == STMT_INPUT) {
+            names.insert({image[i].slot, ""});
+        }
+    }
+    out << PRELUDE;
+    out << "int main(void) {\n";
+    out << "    setvbuf(stdout, outputBuffer, _IOFBF, sizeof outputBuffer);\n";
+    for (auto &entry : names) {
+        int slot = entry.first;
+        bool defined = state.isDefined(slot);
+        out << "    int v" << slot << " = " << (defined ? literal(state.getValue(slot)) : "0") << ";\n";
+        out << "    char d" << slot << " = " << defined << ";";
+        if (!entry.second.empty()) out << "  " << comment(entry.second);
+        out << "\n";
+    }
+    for (int i = 0; i < size; i++) {
+        statement(image[i], i);
+    }
+    out << "program_end:\n";
+    out << "    return 0;\n";
+    out << "}\n";
+}
+
+void writeProgramSource(Program &program, EvalState &state, std::ostream &out) {
+    SourceWriter writer(program, out);
+    writer.write(state);
+}
+
+/*
+ * Implementation notes: compileProgram
+ * ------------------------------------
+ * The compiler is started with posix_spawnp rather than through the
+ * shell, so the path needs no quoting.  Output is flushed first, since
+ * the compiler shares the interpreter's standard output.
+ */
+
+void compileProgram(Program &program, EvalState &state, const std::string &path) {
+    program.link();
+    std::string source = path + ".c";
+    std::ofstream file(source);
+    if (!file) error("COMPILE FAILED");
+    writeProgramSource(program, state, file);
+    file.close();
+    if (!file) error("COMPILE FAILED");
+    const char *cc = getenv("CC");
+    if (cc == nullptr || *cc == '\0') cc = "cc";
+    std::string compiler = cc;
+    std::string optimize = "-O2";
+    std::string outputFlag = "-o";
+    std::string output = path;
+    std::vector<char *> argv = {&compiler[0], &optimize[0], &outputFlag[0], &output[0], &source[0], nullptr};
+    standardOutput().flush();
+    pid_t pid;
+    if (posix_spawnp(&pid, cc, nullptr, nullptr, argv.data(), environ) != 0) error("COMPILE FAILED");
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) error("COMPILE FAILED");
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) error("COMPILE FAILED");
+}
@@ -0,0 +1,43 @@
+/*
+ * File: compiler.h
+ * ----------------
+ * This interface exports the ahead-of-time compiler behind the COMPILE
+ * command, which turns a BASIC program into C source and builds it
+ * into a standalone executable.
+ */
+
+#ifndef _compiler_h
+#define _compiler_h
+
+#include <ostream>
+#include <string>
+#include "program.hpp"
+#include "evalstate.hpp"
+
+/*
+ * Function: writeProgramSource
+ * Usage: writeProgramSource(program, state, out);
+ * -----------------------------------------------
+ * Writes a C translation of the linked program to out.  Every line
+ * that does something when run gets a label, GOTO and IF become goto
+ * statements, and every variable becomes an int local together with
+ * a flag saying whether it is defined.  The variables start out with
+ * the values they have in state, which is what RUN would see.  The
+ * program prints exactly what RUN would, errors included.
+ */
+
+void writeProgramSource(Program &program, EvalState &state, std::ostream &out);
+
+/*
+ * Function: compileProgram
+ * Usage: compileProgram(program, state, path);
+ * --------------------------------------------
+ * Links the program, writes its C translation to path with ".c"
+ * appended and runs the C compiler named by the CC environment
+ * variable, or cc, to build the executable path.  Raises an error if
+ * the source cannot be written or the compiler fails.
+ */
+
+void compileProgram(Program &program, EvalState &state, const std::string &path);
+
+#endif
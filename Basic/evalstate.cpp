@@ -16,20 +16,33 @@
 
 
 
-void EvalState::setValue(std::string var, int value) {
-    if(isDefined(var)) symbolTable[var] = value;
-    else symbolTable.emplace(var,value);
+void EvalState::setValue(const std::string &var, int value) {
+    setValue(getSlot(var), value);
 }
 
-int EvalState::getValue(std::string var) {
-    if (isDefined(var)) return symbolTable[var];
-    else return 0;
+int EvalState::getValue(const std::string &var) {
+    auto it = slotIndex.find(var);
+    if (it == slotIndex.end()) return 0;
+    return getValue(it->second);
 }
 
-bool EvalState::isDefined(std::string var) {
-    return symbolTable.find(var) != symbolTable.end();
+bool EvalState::isDefined(const std::string &var) {
+    auto it = slotIndex.find(var);
+    return it != slotIndex.end() && isDefined(it->second);
+}
+
+int EvalState::getSlot(const std::string &var) {
+    auto it = slotIndex.find(var);
+    if (it != slotIndex.end()) return it->second;
+    int slot = slots.size();
+    slotIndex.emplace(var, slot);
+    slots.push_back({0, false});
+    return slot;
 }
 
 void EvalState::Clear() {
-    symbolTable.clear();
-}
\ No newline at end of file
+    for (Slot &slot : slots) {
+        slot.value = 0;
+        slot.defined = false;
+    }
+}
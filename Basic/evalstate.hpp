@@ -10,7 +10,8 @@
 #define _evalstate_h
 
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 /*
  * Class: EvalState
@@ -20,8 +21,12 @@
  * environment that the evaluator may need to know.  In this
  * version, the only information maintained by the EvalState class
  * is a symbol table that maps variable names into their values.
- * In your implementation, you may include additional information
- * in the EvalState class.
+ *
+ * Values are kept in a flat array of slots.  Each distinct variable
+ * name is given a dense slot index the first time it is seen, and
+ * parsed programs refer to variables by that index, so reading a
+ * variable while the program runs is a single indexed load.  The
+ * name-based methods remain available and go through the same slots.
  */
 
 class EvalState {
@@ -57,7 +62,7 @@ public:
  * Sets the value associated with the specified var.
  */
 
-    void setValue(std::string var, int value);
+    void setValue(const std::string &var, int value);
 
 /*
  * Method: getValue
@@ -66,7 +71,7 @@ public:
  * Returns the value associated with the specified variable.
  */
 
-    int getValue(std::string var);
+    int getValue(const std::string &var);
 
 /*
  * Method: isDefined
@@ -75,13 +80,81 @@ public:
  * Returns true if the specified variable is defined.
  */
 
-    bool isDefined(std::string var);
+    bool isDefined(const std::string &var);
+
+/*
+ * Method: getSlot
+ * Usage: int slot = state.getSlot(var);
+ * -------------------------------------
+ * Returns the slot index for the specified variable, assigning the
+ * next free index if the name has not been seen before.  A new slot
+ * starts out undefined.
+ */
+
+    int getSlot(const std::string &var);
+
+/*
+ * Methods: setValue, getValue, isDefined (slot versions)
+ * Usage: state.setValue(slot, value);
+ *        int value = state.getValue(slot);
+ *        if (state.isDefined(slot)) . . .
+ * --------------------------------------------------------
+ * These methods access a variable through a slot index previously
+ * returned by getSlot.
+ */
+
+    void setValue(int slot, int value) {
+        slots[slot].value = value;
+        slots[slot].defined = true;
+    }
+
+    int getValue(int slot) const {
+        return slots[slot].value;
+    }
+
+    bool isDefined(int slot) const {
+        return slots[slot].defined;
+    }
+
+/*
+ * Type: Slot
+ * ----------
+ * The storage of one variable.  Native code generated for a program
+ * reads and writes these fields directly.
+ */
+
+    struct Slot {
+        int value;
+        bool defined;
+    };
+
+/*
+ * Method: getSlots
+ * Usage: EvalState::Slot *slots = state.getSlots();
+ * -------------------------------------------------
+ * Returns the slot array, indexed by slot number.  The pointer stays
+ * valid until a new variable name is given a slot.
+ */
+
+    Slot *getSlots() {
+        return slots.data();
+    }
+
+/*
+ * Method: Clear
+ * Usage: state.Clear();
+ * ---------------------
+ * Makes every variable undefined.  Slot indices stay assigned, so
+ * statements that were resolved earlier remain valid.
+ */
 
     void Clear();
 
 private:
 
-    std::map<std::string, int> symbolTable;
+    std::unordered_map<std::string, int> slotIndex;
+
+    std::vector<Slot> slots;
 
 };
 
@@ -5,6 +5,7 @@
  */
 
 #include "exp.hpp"
+#include "arena.hpp"
 #include "Utils/error.hpp"
 #include "Utils/strlib.hpp"
 #include "evalstate.hpp"
@@ -12,13 +13,22 @@
 /*
  * Implementation notes: the Expression class
  * ------------------------------------------
- * The Expression class declares no instance variables and needs no code.
+ * The Expression class declares no instance variables.  Its only code
+ * routes node allocation through the arena.
  */
 
 Expression::Expression() = default;
 
 Expression::~Expression() = default;
 
+void *Expression::operator new(size_t size) {
+    return NodeArena::allocate(size);
+}
+
+void Expression::operator delete(void *ptr) {
+    NodeArena::deallocate(ptr);
+}
+
 /*
  * Implementation notes: the ConstantExp subclass
  * ----------------------------------------------
@@ -55,13 +65,17 @@ int ConstantExp::getValue() {
  * look this variable up in the evaluation state.
  */
 
-IdentifierExp::IdentifierExp(std::string name) {
-    this->name = name;
+IdentifierExp::IdentifierExp(std::string_view name) : name(name) {
+    this->slot = -1;
 }
 
 int IdentifierExp::eval(EvalState &state) {
-    if (!state.isDefined(name)) error("VARIABLE NOT DEFINED");
-    return state.getValue(name);
+    if (slot < 0) {
+        if (!state.isDefined(name)) error("VARIABLE NOT DEFINED");
+        return state.getValue(name);
+    }
+    if (!state.isDefined(slot)) error("VARIABLE NOT DEFINED");
+    return state.getValue(slot);
 }
 
 std::string IdentifierExp::toString() {
@@ -72,10 +86,18 @@ ExpressionType IdentifierExp::getType() {
     return IDENTIFIER;
 }
 
-std::string IdentifierExp::getName() {
+const std::string &IdentifierExp::getName() {
     return name;
 }
 
+int IdentifierExp::getSlot() {
+    return slot;
+}
+
+void IdentifierExp::setSlot(int slot) {
+    this->slot = slot;
+}
+
 /*
  * Implementation notes: the CompoundExp subclass
  * ----------------------------------------------
@@ -84,7 +106,7 @@ std::string IdentifierExp::getName() {
  * evaluates the subexpressions recursively and then applies the operator.
  */
 
-CompoundExp::CompoundExp(std::string op, Expression *lhs, Expression *rhs) {
+CompoundExp::CompoundExp(char op, Expression *lhs, Expression *rhs) {
     this->op = op;
     this->lhs = lhs;
     this->rhs = rhs;
@@ -104,22 +126,24 @@ CompoundExp::~CompoundExp() {
  */
 
 int CompoundExp::eval(EvalState &state) {
-    if (op == "=") {
+    if (op == '=') {
         if (lhs->getType() != IDENTIFIER) {
             error("Illegal variable in assignment");
         }
-        if (lhs->getType() == IDENTIFIER && lhs->toString() == "LET")
+        IdentifierExp *var = (IdentifierExp *) lhs;
+        if (var->getName() == "LET")
             error("SYNTAX ERROR");
         int val = rhs->eval(state);
-        state.setValue(((IdentifierExp *) lhs)->getName(), val);
+        if (var->getSlot() < 0) state.setValue(var->getName(), val);
+        else state.setValue(var->getSlot(), val);
         return val;
     }
     int left = lhs->eval(state);
     int right = rhs->eval(state);
-    if (op == "+") return left + right;
-    if (op == "-") return left - right;
-    if (op == "*") return left * right;
-    if (op == "/") {
+    if (op == '+') return left + right;
+    if (op == '-') return left - right;
+    if (op == '*') return left * right;
+    if (op == '/') {
         if (right == 0) error("DIVIDE BY ZERO");
         return left / right;
     }
@@ -135,7 +159,7 @@ ExpressionType CompoundExp::getType() {
 }
 
 std::string CompoundExp::getOp() {
-    return op;
+    return std::string(1, op);
 }
 
 Expression *CompoundExp::getLHS() {
@@ -144,4 +168,12 @@ Expression *CompoundExp::getLHS() {
 
 Expression *CompoundExp::getRHS() {
     return rhs;
-}
\ No newline at end of file
+}
+
+void CompoundExp::setLHS(Expression *lhs) {
+    this->lhs = lhs;
+}
+
+void CompoundExp::setRHS(Expression *rhs) {
+    this->rhs = rhs;
+}
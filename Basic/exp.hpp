@@ -10,6 +10,7 @@
 #define _exp_h
 
 #include <string>
+#include <string_view>
 #include "evalstate.hpp"
 
 
@@ -71,6 +72,18 @@ public:
 
     virtual ~Expression();
 
+/*
+ * Operators: new, delete
+ * ----------------------
+ * Expression nodes are allocated from the current NodeArena, if any,
+ * and from the heap otherwise.  Client code creates and deletes them
+ * with new and delete as usual.
+ */
+
+    static void *operator new(size_t size);
+
+    static void operator delete(void *ptr);
+
 /*
  * Method: eval
  * Usage: int value = exp->eval(state);
@@ -169,7 +182,7 @@ public:
  * for the variable named by name.
  */
 
-    IdentifierExp(std::string name);
+    IdentifierExp(std::string_view name);
 
 /*
  * Prototypes for the virtual methods
@@ -192,12 +205,28 @@ public:
  * to an object known to be an IdentifierExp.
  */
 
-    std::string getName();
+    const std::string &getName();
+
+/*
+ * Methods: getSlot, setSlot
+ * Usage: int slot = ((IdentifierExp *) exp)->getSlot();
+ *        ((IdentifierExp *) exp)->setSlot(slot);
+ * -----------------------------------------------------
+ * These methods read and set the EvalState slot assigned to this
+ * variable by resolveVariables.  The slot is -1 until it has been
+ * resolved, in which case eval looks the variable up by name.
+ */
+
+    int getSlot();
+
+    void setSlot(int slot);
 
 private:
 
     std::string name;
 
+    int slot;
+
 };
 
 /*
@@ -217,10 +246,11 @@ public:
  * -------------------------------------------------------
  * The constructor initializes a new compound expression
  * which is composed of the operator (op) and the left and
- * right subexpression (lhs and rhs).
+ * right subexpression (lhs and rhs).  Every operator of the
+ * language is a single character, which is all the node keeps.
  */
 
-    CompoundExp(std::string op, Expression *lhs, Expression *rhs);
+    CompoundExp(char op, Expression *lhs, Expression *rhs);
 
 /*
  * Prototypes for the virtual methods
@@ -253,9 +283,23 @@ public:
 
     Expression *getRHS();
 
+/*
+ * Methods: setLHS, setRHS
+ * Usage: ((CompoundExp *) exp)->setLHS(lhs);
+ *        ((CompoundExp *) exp)->setRHS(rhs);
+ * -------------------------------------------
+ * These methods replace a subexpression of a compound node.  The node
+ * takes ownership of the new subexpression; the old one is not freed,
+ * so the caller can keep it or delete it.
+ */
+
+    void setLHS(Expression *lhs);
+
+    void setRHS(Expression *rhs);
+
 private:
 
-    std::string op;
+    char op;
     Expression *lhs, *rhs;
 
 };
@@ -0,0 +1,581 @@
+/*
+ * File: jit.cpp
+ * -------------
+ * This file implements the NativeCode class.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "jit.hpp"
+#include "exp.hpp"
+#include "keyword.hpp"
+#include "output.hpp"
+#include "Utils/error.hpp"
+
+#if defined(BASIC_JIT) && defined(__x86_64__) && defined(__linux__)
+#define BASIC_NATIVE_JIT
+#include <sys/mman.h>
+#endif
+
+/*
+ * Type: ExitCode
+ * --------------
+ * The value the generated code returns.  Every code except EXIT_END
+ * stands for the error whose message has the same index in
+ * EXIT_MESSAGES.
+ */
+
+enum ExitCode {
+    EXIT_END, EXIT_UNDEFINED, EXIT_DIVIDE, EXIT_ASSIGNMENT, EXIT_SYNTAX, EXIT_COUNT
+};
+
+static const char *const EXIT_MESSAGES[EXIT_COUNT] = {
+    "", "VARIABLE NOT DEFINED", "DIVIDE BY ZERO", "Illegal variable in assignment", "SYNTAX ERROR"
+};
+
+typedef int (*EntryPoint)(EvalState::Slot *slots, OutputSink *out, EvalState *state);
+
+#ifdef BASIC_NATIVE_JIT
+
+/*
+ * Runtime helpers
+ * ---------------
+ * Everything the generated code cannot do with a few instructions is
+ * done by calling one of these.  None of them raises an error, since
+ * an exception could not unwind through the generated frames.
+ */
+
+static void printValue(OutputSink *out, int value) {
+    out->writeInt(value);
+    out->endLine();
+}
+
+static void inputValue(int slot, EvalState *state) {
+    readInput(slot, *state);
+}
+
+static void reportMissingLine() {
+    lineNumberError();
+}
+
+/*
+ * Class: Assembler
+ * ----------------
+ * Collects the machine code and the jumps that still need their
+ * targets.  The register use is fixed:
+ *
+ *   rbx -- the slot array
+ *   r12 -- the output sink
+ *   r13 -- the EvalState, for INPUT
+ *   eax -- the value of the expression being computed
+ *   ecx -- the right operand of a binary operator
+ *
+ * Intermediate values that do not fit in this scheme are pushed on
+ * the machine stack.  Nothing is called while a value is pushed, so
+ * the stack is aligned for every call, and the exits restore rsp from
+ * rbp, so they may be taken with values still pushed.
+ */
+
+class Assembler {
+
+public:
+
+    std::vector<unsigned char> bytes;
+
+    void byte(int b) {
+        bytes.push_back((unsigned char) b);
+    }
+
+    void bytes2(int b1, int b2) {
+        byte(b1);
+        byte(b2);
+    }
+
+    void word(int32_t value) {
+        unsigned char raw[4];
+        std::memcpy(raw, &value, 4);
+        bytes.insert(bytes.end(), raw, raw + 4);
+    }
+
+    void quad(uint64_t value) {
+        unsigned char raw[8];
+        std::memcpy(raw, &value, 8);
+        bytes.insert(bytes.end(), raw, raw + 8);
+    }
+
+    size_t here() {
+        return bytes.size();
+    }
+
+/*
+ * Methods: jump, jumpIf, patch
+ * ----------------------------
+ * Emit a jump with a 32-bit displacement and return the position of
+ * the displacement, which patch later points at its destination.
+ */
+
+    size_t jump() {
+        byte(0xE9);
+        word(0);
+        return here() - 4;
+    }
+
+    size_t jumpIf(int condition) {
+        bytes2(0x0F, 0x80 | condition);
+        word(0);
+        return here() - 4;
+    }
+
+    void patch(size_t at, size_t destination) {
+        int32_t displacement = (int32_t) (destination - (at + 4));
+        std::memcpy(&bytes[at], &displacement, 4);
+    }
+
+    void call(const void *function) {
+        bytes2(0x48, 0xB8);                          /* mov rax, imm64      */
+        quad((uint64_t) (uintptr_t) function);
+        bytes2(0xFF, 0xD0);                          /* call rax            */
+    }
+
+    /* An instruction whose operand is [rbx + disp32] */
+
+    void slotOperand(int opcode, int reg, int32_t displacement) {
+        byte(opcode);
+        byte(0x80 | (reg << 3) | 3);
+        word(displacement);
+    }
+
+};
+
+/* Condition codes of the jcc instructions */
+
+static const int CC_EQUAL = 0x4;
+static const int CC_LESS = 0xC;
+static const int CC_GREATER = 0xF;
+
+/* Register numbers in ModRM fields */
+
+static const int REG_EAX = 0;
+static const int REG_ECX = 1;
+
+static int32_t valueOffset(int slot) {
+    return slot * (int32_t) sizeof(EvalState::Slot) + offsetof(EvalState::Slot, value);
+}
+
+static int32_t definedOffset(int slot) {
+    return slot * (int32_t) sizeof(EvalState::Slot) + offsetof(EvalState::Slot, defined);
+}
+
+/*
+ * Class: Translator
+ * -----------------
+ * Translates a program image.  The positions of the records are kept
+ * so that jumps can be patched once every record has been emitted, and
+ * jumps to an exit are collected per exit code.
+ */
+
+class Translator {
+
+public:
+
+    Assembler a;
+
+    bool translate(const StatementRecord *image, int size);
+
+private:
+
+    std::vector<size_t> recordStart;
+
+    std::vector<std::pair<size_t, int>> recordJumps;   /* (jump, record)  */
+
+    std::vector<std::pair<size_t, int>> exitJumps;     /* (jump, exit)    */
+
+    std::vector<size_t> returnJumps;
+
+    void exitIf(int condition, ExitCode exit);
+
+    void exitNow(ExitCode exit);
+
+    void checkDefined(int slot);
+
+    bool loadSlot(int slot, int reg);
+
+    bool expression(Expression *exp);
+
+    bool assignment(CompoundExp *exp);
+
+    bool binary(TokenKind op, Expression *rhs);
+
+    bool rightOperand(Expression *rhs, int opcode, int immediate);
+
+    bool statement(const StatementRecord &rec);
+
+    bool condition(const StatementRecord &rec);
+
+    void jumpTo(int target);
+
+    void returnNow();
+
+};
+
+void Translator::exitIf(int condition, ExitCode exit) {
+    exitJumps.push_back({a.jumpIf(condition), exit});
+}
+
+void Translator::exitNow(ExitCode exit) {
+    exitJumps.push_back({a.jump(), exit});
+}
+
+/*
+ * Implementation notes: checkDefined, loadSlot
+ * --------------------------------------------
+ * Reading a variable checks its defined flag first, exactly where the
+ * interpreter would check it.
+ */
+
+void Translator::checkDefined(int slot) {
+    a.slotOperand(0x80, 7, definedOffset(slot));     /* cmp byte [slot], 0  */
+    a.byte(0);
+    exitIf(CC_EQUAL, EXIT_UNDEFINED);
+}
+
+bool Translator::loadSlot(int slot, int reg) {
+    if (slot < 0) return false;
+    checkDefined(slot);
+    a.slotOperand(0x8B, reg, valueOffset(slot));     /* mov reg, [slot]     */
+    return true;
+}
+
+/*
+ * Implementation notes: expression
+ * --------------------------------
+ * Leaves the value of the expression in eax.  The left operand of a
+ * binary operator is always evaluated first, so errors come out in
+ * the same order as from CompoundExp::eval.
+ */
+
+bool Translator::expression(Expression *exp) {
+    switch (exp->getType()) {
+        case CONSTANT:
+            a.byte(0xB8);                                /* mov eax, imm32      */
+            a.word(((ConstantExp *) exp)->getValue());
+            return true;
+        case IDENTIFIER:
+            return loadSlot(((IdentifierExp *) exp)->getSlot(), REG_EAX);
+        case COMPOUND:
+            break;
+    }
+    CompoundExp *compound = (CompoundExp *) exp;
+    TokenKind op = classifyToken(compound->getOp());
+    if (op == TOK_EQUALS) return assignment(compound);
+    if (!expression(compound->getLHS())) return false;
+    return binary(op, compound->getRHS());
+}
+
+bool Translator::assignment(CompoundExp *exp) {
+    Expression *lhs = exp->getLHS();
+    if (lhs->getType() != IDENTIFIER) {
+        exitNow(EXIT_ASSIGNMENT);
+        return true;
+    }
+    IdentifierExp *var = (IdentifierExp *) lhs;
+    if (var->getName() == "LET") {
+        exitNow(EXIT_SYNTAX);
+        return true;
+    }
+    if (var->getSlot() < 0 || !expression(exp->getRHS())) return false;
+    a.slotOperand(0x89, REG_EAX, valueOffset(var->getSlot()));   /* mov [slot], eax */
+    a.slotOperand(0xC6, 0, definedOffset(var->getSlot()));       /* mov byte [slot], 1 */
+    a.byte(1);
+    return true;
+}
+
+/*
+ * Implementation notes: binary
+ * ----------------------------
+ * Applies op to eax and the value of rhs.  A constant or a variable on
+ * the right is used in place; anything else is computed while the
+ * left operand waits on the stack.
+ */
+
+bool Translator::binary(TokenKind op, Expression *rhs) {
+    if (op == TOK_DIVIDE) {
+        if (rhs->getType() == CONSTANT) {
+            int divisor = ((ConstantExp *) rhs)->getValue();
+            if (divisor == 0) {
+                exitNow(EXIT_DIVIDE);
+                return true;
+            }
+            a.byte(0xB9);                                /* mov ecx, imm32      */
+            a.word(divisor);
+        } else if (rhs->getType() == IDENTIFIER) {
+            if (!loadSlot(((IdentifierExp *) rhs)->getSlot(), REG_ECX)) return false;
+            a.bytes2(0x85, 0xC9);                        /* test ecx, ecx       */
+            exitIf(CC_EQUAL, EXIT_DIVIDE);
+        } else {
+            a.byte(0x50);                                /* push rax            */
+            if (!expression(rhs)) return false;
+            a.bytes2(0x89, 0xC1);                        /* mov ecx, eax        */
+            a.byte(0x58);                                /* pop rax             */
+            a.bytes2(0x85, 0xC9);                        /* test ecx, ecx       */
+            exitIf(CC_EQUAL, EXIT_DIVIDE);
+        }
+        a.byte(0x99);                                    /* cdq                 */
+        a.bytes2(0xF7, 0xF9);                            /* idiv ecx            */
+        return true;
+    }
+    switch (op) {
+        case TOK_PLUS:
+            return rightOperand(rhs, 0x03, 0x05);       /* add                 */
+        case TOK_MINUS:
+            return rightOperand(rhs, 0x2B, 0x2D);       /* sub                 */
+        case TOK_TIMES:
+            return rightOperand(rhs, 0xAF, 0x69);       /* imul                */
+        default:
+            return false;
+    }
+}
+
+/*
+ * Implementation notes: rightOperand
+ * ----------------------------------
+ * Emits eax = eax op rhs.  opcode is the "op r32, r/m32" form, which
+ * for imul follows a 0F prefix, and immediate the form that takes a
+ * 32-bit constant.
+ */
+
+bool Translator::rightOperand(Expression *rhs, int opcode, int immediate) {
+    bool multiply = (opcode == 0xAF);
+    if (rhs->getType() == CONSTANT) {
+        if (multiply) a.bytes2(immediate, 0xC0);       /* imul eax, eax, imm32 */
+        else a.byte(immediate);                         /* add/sub eax, imm32   */
+        a.word(((ConstantExp *) rhs)->getValue());
+        return true;
+    }
+    if (rhs->getType() == IDENTIFIER) {
+        int slot = ((IdentifierExp *) rhs)->getSlot();
+        if (slot < 0) return false;
+        checkDefined(slot);
+        if (multiply) a.byte(0x0F);
+        a.slotOperand(opcode, REG_EAX, valueOffset(slot));
+        return true;
+    }
+    a.byte(0x50);                                        /* push rax            */
+    if (!expression(rhs)) return false;
+    a.bytes2(0x89, 0xC1);                                /* mov ecx, eax        */
+    a.byte(0x58);                                        /* pop rax             */
+    if (multiply) a.byte(0x0F);
+    a.bytes2(opcode, 0xC1);                              /* op eax, ecx         */
+    return true;
+}
+
+void Translator::jumpTo(int target) {
+    recordJumps.push_back({a.jump(), target});
+}
+
+void Translator::returnNow() {
+    a.bytes2(0x31, 0xC0);                                /* xor eax, eax        */
+    returnJumps.push_back(a.jump());
+}
+
+/*
+ * Implementation notes: condition
+ * -------------------------------
+ * Compares the two sides of an IF and jumps to the target when the
+ * comparison holds.  A comparison the interpreter never treats as true
+ * produces no jump at all.
+ */
+
+bool Translator::condition(const StatementRecord &rec) {
+    if (!expression(rec.lhs)) return false;
+    Expression *rhs = rec.rhs;
+    if (rhs->getType() == CONSTANT) {
+        a.byte(0x3D);                                    /* cmp eax, imm32      */
+        a.word(((ConstantExp *) rhs)->getValue());
+    } else if (rhs->getType() == IDENTIFIER) {
+        int slot = ((IdentifierExp *) rhs)->getSlot();
+        if (slot < 0) return false;
+        checkDefined(slot);
+        a.slotOperand(0x3B, REG_EAX, valueOffset(slot)); /* cmp eax, [slot]     */
+    } else {
+        a.byte(0x50);
+        if (!expression(rhs)) return false;
+        a.bytes2(0x89, 0xC1);
+        a.byte(0x58);
+        a.bytes2(0x39, 0xC8);                            /* cmp eax, ecx        */
+    }
+    int taken;
+    switch (rec.op) {
+        case '=': taken = CC_EQUAL; break;
+        case '<': taken = CC_LESS; break;
+        case '>': taken = CC_GREATER; break;
+        default: return true;
+    }
+    if (rec.target >= 0) {
+        recordJumps.push_back({a.jumpIf(taken), rec.target});
+    } else {
+        size_t skip = a.jumpIf(taken ^ 1);               /* the opposite test   */
+        a.call((const void *) &reportMissingLine);
+        a.patch(skip, a.here());
+    }
+    return true;
+}
+
+bool Translator::statement(const StatementRecord &rec) {
+    switch (rec.opcode) {
+        case STMT_NOP:
+            return true;
+        case STMT_LET:
+            if (rec.slot < 0 || !expression(rec.lhs)) return false;
+            a.slotOperand(0x89, REG_EAX, valueOffset(rec.slot));
+            a.slotOperand(0xC6, 0, definedOffset(rec.slot));
+            a.byte(1);
+            return true;
+        case STMT_PRINT:
+            if (!expression(rec.lhs)) return false;
+            a.bytes2(0x89, 0xC6);                        /* mov esi, eax        */
+            a.byte(0x4C);                                /* mov rdi, r12        */
+            a.bytes2(0x89, 0xE7);
+            a.call((const void *) &printValue);
+            return true;
+        case STMT_INPUT:
+            if (rec.slot < 0) return false;
+            a.byte(0xBF);                                /* mov edi, imm32      */
+            a.word(rec.slot);
+            a.byte(0x4C);                                /* mov rsi, r13        */
+            a.bytes2(0x89, 0xEE);
+            a.call((const void *) &inputValue);
+            return true;
+        case STMT_GOTO:
+            if (rec.target >= 0) {
+                jumpTo(rec.target);
+            } else {
+                a.call((const void *) &reportMissingLine);
+            }
+            return true;
+        case STMT_IF:
+            return condition(rec);
+        case STMT_END:
+        case STMT_HALT:
+            returnNow();
+            return true;
+    }
+    return false;
+}
+
+/*
+ * Implementation notes: translate
+ * -------------------------------
+ * The frame saves rbx, r12 and r13 below rbp and pads rsp to a multiple
+ * of 16.  Each exit loads its code into eax and joins the common
+ * return sequence, which finds the saved registers through rbp.
+ */
+
+bool Translator::translate(const StatementRecord *image, int size) {
+    a.byte(0x55);                                        /* push rbp            */
+    a.byte(0x48);                                        /* mov rbp, rsp        */
+    a.bytes2(0x89, 0xE5);
+    a.byte(0x53);                                        /* push rbx            */
+    a.bytes2(0x41, 0x54);                                /* push r12            */
+    a.bytes2(0x41, 0x55);                                /* push r13            */
+    a.bytes2(0x48, 0x83);                                /* sub rsp, 8          */
+    a.bytes2(0xEC, 0x08);
+    a.byte(0x48);                                        /* mov rbx, rdi        */
+    a.bytes2(0x89, 0xFB);
+    a.byte(0x49);                                        /* mov r12, rsi        */
+    a.bytes2(0x89, 0xF4);
+    a.byte(0x49);                                        /* mov r13, rdx        */
+    a.bytes2(0x89, 0xD5);
+    recordStart.resize(size);
+    for (int i = 0; i < size; i++) {
+        recordStart[i] = a.here();
+        if (!statement(image[i])) return false;
+    }
+    size_t epilogue = a.here();
+    a.byte(0x48);                                        /* lea rsp, [rbp - 24] */
+    a.bytes2(0x8D, 0x65);
+    a.byte(0xE8);
+    a.bytes2(0x41, 0x5D);                                /* pop r13             */
+    a.bytes2(0x41, 0x5C);                                /* pop r12             */
+    a.byte(0x5B);                                        /* pop rbx             */
+    a.byte(0x5D);                                        /* pop rbp             */
+    a.byte(0xC3);                                        /* ret                 */
+    std::vector<size_t> exitStart(EXIT_COUNT);
+    for (int code = EXIT_UNDEFINED; code < EXIT_COUNT; code++) {
+        exitStart[code] = a.here();
+        a.byte(0xB8);                                    /* mov eax, code       */
+        a.word(code);
+        a.patch(a.jump(), epilogue);
+    }
+    for (auto &jump : recordJumps) {
+        if (jump.second >= size) return false;
+        a.patch(jump.first, recordStart[jump.second]);
+    }
+    for (auto &jump : exitJumps) {
+        a.patch(jump.first, exitStart[jump.second]);
+    }
+    for (size_t jump : returnJumps) {
+        a.patch(jump, epilogue);
+    }
+    return true;
+}
+
+#endif
+
+NativeCode::NativeCode() : code(nullptr), size(0) {}
+
+NativeCode::~NativeCode() {
+    clear();
+}
+
+/*
+ * Implementation notes: compile
+ * -----------------------------
+ * The code is written into ordinary read-write pages, which are then
+ * made executable and read-only, so no page is ever both writable and
+ * executable.
+ */
+
+bool NativeCode::compile(const StatementRecord *image, int size) {
+    clear();
+#ifdef BASIC_NATIVE_JIT
+    Translator translator;
+    if (!translator.translate(image, size)) return false;
+    std::vector<unsigned char> &bytes = translator.a.bytes;
+    void *ptr = mmap(nullptr, bytes.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) return false;
+    std::memcpy(ptr, bytes.data(), bytes.size());
+    if (mprotect(ptr, bytes.size(), PROT_READ | PROT_EXEC) != 0) {
+        munmap(ptr, bytes.size());
+        return false;
+    }
+    code = ptr;
+    this->size = bytes.size();
+    return true;
+#else
+    (void) image;
+    (void) size;
+    return false;
+#endif
+}
+
+bool NativeCode::isReady() {
+    return code != nullptr;
+}
+
+void NativeCode::run(EvalState &state) {
+    EntryPoint entry = (EntryPoint) code;
+    int exit = entry(state.getSlots(), &standardOutput(), &state);
+    if (exit != EXIT_END) error(EXIT_MESSAGES[exit]);
+}
+
+void NativeCode::clear() {
+#ifdef BASIC_NATIVE_JIT
+    if (code != nullptr) munmap(code, size);
+#endif
+    code = nullptr;
+    size = 0;
+}
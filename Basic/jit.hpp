@@ -0,0 +1,106 @@
+/*
+ * File: jit.h
+ * -----------
+ * This interface exports the NativeCode class, the optional tier that
+ * translates a linked program image into x86-64 machine code.
+ */
+
+#ifndef _jit_h
+#define _jit_h
+
+#include <cstddef>
+#include "statement.hpp"
+#include "evalstate.hpp"
+
+/*
+ * Class: NativeCode
+ * -----------------
+ * The machine code for one program image.  Each record becomes a short
+ * sequence of instructions, GOTO and IF become direct jumps, and the
+ * expressions of LET, PRINT and IF are compiled from their trees with
+ * the value in a register.  The variables stay in the slot array of
+ * the EvalState, which the code addresses through a fixed register,
+ * so the interpreter sees every assignment the code makes.
+ *
+ * Errors leave the code through out-of-line exits, and run raises the
+ * same error the interpreter would have raised at that point.
+ *
+ * The tier is only built with BASIC_JIT on x86-64 Linux.  Everywhere
+ * else, or if executable memory cannot be had, compile fails and the
+ * program has to be run by the interpreter.
+ */
+
+class NativeCode {
+
+public:
+
+/*
+ * Constructor: NativeCode
+ * Usage: NativeCode native;
+ * -------------------------
+ * Creates an object holding no code.
+ */
+
+    NativeCode();
+
+/*
+ * Destructor: ~NativeCode
+ * Usage: usually implicit
+ * -----------------------
+ * Releases the executable memory.
+ */
+
+    ~NativeCode();
+
+    NativeCode(const NativeCode &) = delete;
+
+    NativeCode &operator=(const NativeCode &) = delete;
+
+/*
+ * Method: compile
+ * Usage: if (native.compile(image, size)) ...
+ * -------------------------------------------
+ * Translates the size records of image, which must end with the
+ * STMT_HALT sentinel, replacing any previous code.  Returns false if
+ * no code could be produced.
+ */
+
+    bool compile(const StatementRecord *image, int size);
+
+/*
+ * Method: isReady
+ * Usage: if (native.isReady()) ...
+ * --------------------------------
+ * Returns true if the last call to compile succeeded.
+ */
+
+    bool isReady();
+
+/*
+ * Method: run
+ * Usage: native.run(state);
+ * -------------------------
+ * Runs the code from the first record, exactly as runImage would run
+ * the image it was compiled from.
+ */
+
+    void run(EvalState &state);
+
+/*
+ * Method: clear
+ * Usage: native.clear();
+ * ----------------------
+ * Discards the code.
+ */
+
+    void clear();
+
+private:
+
+    void *code;
+
+    size_t size;
+
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * File: keyword.cpp
+ * -----------------
+ * Implements the keyword.h interface.
+ */
+
+#include "keyword.hpp"
+
+/*
+ * Implementation notes: classifyToken
+ * -----------------------------------
+ * The switch on the length of the token and then on its first
+ * character leaves at most two candidates, so a token is compared
+ * against at most two keywords.  Single-character tokens are decided
+ * by the switch alone.
+ */
+
+TokenKind classifyToken(std::string_view token) {
+    switch (token.length()) {
+        case 1:
+            switch (token[0]) {
+                case '+': return TOK_PLUS;
+                case '-': return TOK_MINUS;
+                case '*': return TOK_TIMES;
+                case '/': return TOK_DIVIDE;
+                case '=': return TOK_EQUALS;
+                case '<': return TOK_LESS;
+                case '>': return TOK_GREATER;
+                case '(': return TOK_LPAREN;
+                case ')': return TOK_RPAREN;
+            }
+            break;
+        case 2:
+            if (token == "IF") return KW_IF;
+            break;
+        case 3:
+            switch (token[0]) {
+                case 'E':
+                    if (token == "END") return KW_END;
+                    break;
+                case 'L':
+                    if (token == "LET") return KW_LET;
+                    break;
+                case 'R':
+                    if (token == "REM") return KW_REM;
+                    if (token == "RUN") return KW_RUN;
+                    break;
+            }
+            break;
+        case 4:
+            switch (token[0]) {
+                case 'G':
+                    if (token == "GOTO") return KW_GOTO;
+                    break;
+                case 'H':
+                    if (token == "HELP") return KW_HELP;
+                    break;
+                case 'L':
+                    if (token == "LIST") return KW_LIST;
+                    break;
+                case 'Q':
+                    if (token == "QUIT") return KW_QUIT;
+                    break;
+                case 'T':
+                    if (token == "THEN") return KW_THEN;
+                    break;
+            }
+            break;
+        case 5:
+            switch (token[0]) {
+                case 'C':
+                    if (token == "CLEAR") return KW_CLEAR;
+                    break;
+                case 'I':
+                    if (token == "INPUT") return KW_INPUT;
+                    break;
+                case 'P':
+                    if (token == "PRINT") return KW_PRINT;
+                    break;
+            }
+            break;
+        case 7:
+            if (token == "COMPILE") return KW_COMPILE;
+            break;
+    }
+    return TOK_OTHER;
+}
@@ -0,0 +1,53 @@
+/*
+ * File: keyword.h
+ * ---------------
+ * This interface classifies the tokens of a BASIC line into the
+ * keywords and operators of the language, so that the interpreter can
+ * dispatch on a small enumerated type instead of comparing strings.
+ */
+
+#ifndef _keyword_h
+#define _keyword_h
+
+#include <string_view>
+
+/*
+ * Type: TokenKind
+ * ---------------
+ * The kinds of token the interpreter distinguishes.  Anything that is
+ * not a keyword or one of the operators below is TOK_OTHER.
+ */
+
+enum TokenKind {
+    TOK_OTHER,
+    KW_REM, KW_LET, KW_PRINT, KW_INPUT, KW_END, KW_GOTO, KW_IF, KW_THEN,
+    KW_RUN, KW_LIST, KW_CLEAR, KW_QUIT, KW_HELP, KW_COMPILE,
+    TOK_PLUS, TOK_MINUS, TOK_TIMES, TOK_DIVIDE,
+    TOK_EQUALS, TOK_LESS, TOK_GREATER, TOK_LPAREN, TOK_RPAREN
+};
+
+/*
+ * Function: classifyToken
+ * Usage: TokenKind kind = classifyToken(token);
+ * ---------------------------------------------
+ * Returns the kind of the specified token.  Keywords are recognized
+ * only in upper case, as elsewhere in the interpreter.
+ */
+
+TokenKind classifyToken(std::string_view token);
+
+/*
+ * Function: isKeyword
+ * Usage: if (isKeyword(kind)) ...
+ * -------------------------------
+ * Returns true if the token kind is one of the reserved words, which
+ * cannot be used as variable names.  COMPILE is not reserved: it is
+ * recognized only as the first word of a command, so programs that
+ * use it as a variable keep working.
+ */
+
+inline bool isKeyword(TokenKind kind) {
+    return kind >= KW_REM && kind <= KW_HELP;
+}
+
+#endif
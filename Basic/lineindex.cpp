@@ -0,0 +1,93 @@
+/*
+ * File: lineindex.cpp
+ * -------------------
+ * This file implements the LineIndex class.
+ */
+
+#include <cstddef>
+#include "lineindex.hpp"
+
+/*
+ * Implementation notes: layout choice
+ * -----------------------------------
+ * The direct table costs one int per number in the range spanned by
+ * the lines.  It is used as long as that is no more than DENSE_FACTOR
+ * ints per line, which covers programs numbered in steps of 10 with
+ * room to spare, plus a small allowance for tiny programs.
+ */
+
+static const long DENSE_FACTOR = 16;
+static const long DENSE_SLACK = 1024;
+
+LineIndex::LineIndex() : dense(true), base(0) {}
+
+void LineIndex::build(const std::vector<int> &lineNumbers, const std::vector<int> &values) {
+    table.clear();
+    keys.clear();
+    keyValues.clear();
+    base = 0;
+    dense = true;
+    if (lineNumbers.empty()) return;
+    long range = (long) lineNumbers.back() - lineNumbers.front() + 1;
+    if (range <= DENSE_FACTOR * (long) lineNumbers.size() + DENSE_SLACK) {
+        base = lineNumbers.front();
+        table.assign(range, -1);
+        for (size_t i = 0; i < lineNumbers.size(); i++) {
+            table[lineNumbers[i] - base] = values[i];
+        }
+    } else {
+        dense = false;
+        keys.resize(lineNumbers.size() + 1);
+        keyValues.resize(lineNumbers.size() + 1);
+        int next = 0;
+        buildEytzinger(lineNumbers, values, next, 1);
+    }
+}
+
+/*
+ * Implementation notes: buildEytzinger
+ * ------------------------------------
+ * An in-order walk of the implicit tree, in which node k has children
+ * 2k and 2k + 1, visits the nodes in sorted order, so filling the
+ * nodes during such a walk from the sorted input gives the layout.
+ */
+
+void LineIndex::buildEytzinger(const std::vector<int> &lineNumbers, const std::vector<int> &values,
+                               int &next, int k) {
+    if (k >= (int) keys.size()) return;
+    buildEytzinger(lineNumbers, values, next, 2 * k);
+    keys[k] = lineNumbers[next];
+    keyValues[k] = values[next];
+    next++;
+    buildEytzinger(lineNumbers, values, next, 2 * k + 1);
+}
+
+/*
+ * Implementation notes: find
+ * --------------------------
+ * The sparse search descends to the right whenever the key is smaller
+ * than the one wanted and stops below a leaf.  The last node where it
+ * went left holds the smallest key not less than the one wanted; the
+ * trailing one bits of k record the right turns taken after it, so
+ * shifting them out, together with that left turn, recovers it.
+ */
+
+int LineIndex::find(int lineNumber) {
+    if (dense) {
+        unsigned offset = (unsigned) lineNumber - (unsigned) base;
+        if (offset >= table.size()) return -1;
+        return table[offset];
+    }
+    int n = keys.size();
+    int k = 1;
+    while (k < n) {
+        k = 2 * k + (keys[k] < lineNumber);
+    }
+    k >>= __builtin_ctz(~k) + 1;
+    if (k == 0 || keys[k] != lineNumber) return -1;
+    return keyValues[k];
+}
+
+bool LineIndex::isDense() {
+    return dense;
+}
@@ -0,0 +1,87 @@
+/*
+ * File: lineindex.h
+ * -----------------
+ * This interface exports the LineIndex class, which maps the line
+ * numbers of a linked program to positions in its image.
+ */
+
+#ifndef _lineindex_h
+#define _lineindex_h
+
+#include <vector>
+
+/*
+ * Class: LineIndex
+ * ----------------
+ * A read-only map from line numbers to integers, built once when the
+ * program is linked and queried for every GOTO and IF target.  The
+ * index picks one of two layouts:
+ *
+ * - If the line numbers are compact, a direct table indexed by line
+ *   number minus the smallest one answers each query with one load.
+ *
+ * - Otherwise the keys are stored in Eytzinger (breadth-first) order,
+ *   so a search walks down an implicit binary tree whose top levels
+ *   share a few cache lines, and each step is a comparison feeding an
+ *   index computation instead of a branch.
+ */
+
+class LineIndex {
+
+public:
+
+/*
+ * Constructor: LineIndex
+ * Usage: LineIndex index;
+ * -----------------------
+ * Creates an empty index.
+ */
+
+    LineIndex();
+
+/*
+ * Method: build
+ * Usage: index.build(lineNumbers, values);
+ * ----------------------------------------
+ * Replaces the contents of the index.  The line numbers must be sorted
+ * in increasing order, and values[i] is the value of lineNumbers[i].
+ */
+
+    void build(const std::vector<int> &lineNumbers, const std::vector<int> &values);
+
+/*
+ * Method: find
+ * Usage: int value = index.find(lineNumber);
+ * ------------------------------------------
+ * Returns the value stored for the line, or -1 if it is not indexed.
+ */
+
+    int find(int lineNumber);
+
+/*
+ * Method: isDense
+ * Usage: if (index.isDense()) ...
+ * -------------------------------
+ * Returns true if the index chose the direct table layout.
+ */
+
+    bool isDense();
+
+private:
+
+    bool dense;
+
+    int base;                      /* Smallest line number (dense)      */
+
+    std::vector<int> table;        /* Dense values, -1 for missing ones */
+
+    std::vector<int> keys;         /* Eytzinger order, from index 1     */
+
+    std::vector<int> keyValues;
+
+    void buildEytzinger(const std::vector<int> &lineNumbers, const std::vector<int> &values,
+                        int &next, int k);
+
+};
+
+#endif
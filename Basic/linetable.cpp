@@ -0,0 +1,181 @@
+/*
+ * File: linetable.cpp
+ * -------------------
+ * This file implements the LineTable class.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "linetable.hpp"
+
+/*
+ * Implementation notes: chunks
+ * ----------------------------
+ * A chunk holds up to CHUNK_SIZE records in sorted order, and every
+ * chunk in the table holds at least one.  A full chunk is split in
+ * half when a line is inserted into its middle.  Lines appended past
+ * the end of the last chunk start a new chunk instead, so a program
+ * typed in order fills its chunks completely.
+ */
+
+static const int CHUNK_SIZE = 64;
+
+struct LineTable::Chunk {
+    int count;
+    LineRecord records[CHUNK_SIZE];
+};
+
+static bool lessLine(const LineRecord &rec, int lineNumber) {
+    return rec.lineNumber < lineNumber;
+}
+
+static bool lineLess(int lineNumber, const LineRecord &rec) {
+    return lineNumber < rec.lineNumber;
+}
+
+LineTable::LineTable() : count(0) {}
+
+LineTable::~LineTable() {
+    clear();
+}
+
+/*
+ * Implementation notes: findChunk
+ * -------------------------------
+ * Returns the last chunk whose first line is not larger than the one
+ * requested, or chunk 0 if every chunk starts after it.  This is the
+ * only chunk that can hold the line or have it inserted.  The last
+ * chunk is tested first, since that is where a program loaded in
+ * order is looked up.
+ */
+
+int LineTable::findChunk(int lineNumber) {
+    if (chunks.empty()) return -1;
+    if (lineNumber >= firstLines.back()) return chunks.size() - 1;
+    int c = std::upper_bound(firstLines.begin(), firstLines.end(), lineNumber) - firstLines.begin() - 1;
+    return std::max(c, 0);
+}
+
+LineRecord *LineTable::find(int lineNumber) {
+    int c = findChunk(lineNumber);
+    if (c < 0) return nullptr;
+    Chunk *chunk = chunks[c];
+    LineRecord *end = chunk->records + chunk->count;
+    LineRecord *rec = std::lower_bound(chunk->records, end, lineNumber, lessLine);
+    if (rec == end || rec->lineNumber != lineNumber) return nullptr;
+    return rec;
+}
+
+LineRecord *LineTable::findNext(int lineNumber) {
+    int c = findChunk(lineNumber);
+    if (c < 0) return nullptr;
+    Chunk *chunk = chunks[c];
+    LineRecord *end = chunk->records + chunk->count;
+    LineRecord *rec = std::upper_bound(chunk->records, end, lineNumber, lineLess);
+    if (rec != end) return rec;
+    if (c + 1 < (int) chunks.size()) return chunks[c + 1]->records;
+    return nullptr;
+}
+
+LineRecord *LineTable::insert(int lineNumber) {
+    if (chunks.empty()) {
+        chunks.push_back(new Chunk());
+        firstLines.push_back(lineNumber);
+    }
+    int c = findChunk(lineNumber);
+    Chunk *chunk = chunks[c];
+    int pos = std::lower_bound(chunk->records, chunk->records + chunk->count, lineNumber, lessLine) - chunk->records;
+    if (pos < chunk->count && chunk->records[pos].lineNumber == lineNumber) {
+        return &chunk->records[pos];
+    }
+    if (chunk->count == CHUNK_SIZE) {
+        Chunk *next = new Chunk();
+        if (pos == CHUNK_SIZE && c + 1 == (int) chunks.size()) {
+            next->count = 0;
+        } else {
+            int half = CHUNK_SIZE / 2;
+            next->count = CHUNK_SIZE - half;
+            std::memcpy(next->records, chunk->records + half, next->count * sizeof(LineRecord));
+            chunk->count = half;
+        }
+        chunks.insert(chunks.begin() + c + 1, next);
+        firstLines.insert(firstLines.begin() + c + 1, next->count > 0 ? next->records[0].lineNumber : lineNumber);
+        if (pos >= CHUNK_SIZE || pos > chunk->count) {
+            pos -= chunk->count;
+            chunk = next;
+            c++;
+        }
+    }
+    std::memmove(chunk->records + pos + 1, chunk->records + pos, (chunk->count - pos) * sizeof(LineRecord));
+    chunk->records[pos] = {lineNumber, 0, nullptr, nullptr};
+    chunk->count++;
+    firstLines[c] = chunk->records[0].lineNumber;
+    count++;
+    return &chunk->records[pos];
+}
+
+void LineTable::erase(int lineNumber) {
+    int c = findChunk(lineNumber);
+    if (c < 0) return;
+    Chunk *chunk = chunks[c];
+    int pos = std::lower_bound(chunk->records, chunk->records + chunk->count, lineNumber, lessLine) - chunk->records;
+    if (pos == chunk->count || chunk->records[pos].lineNumber != lineNumber) return;
+    std::memmove(chunk->records + pos, chunk->records + pos + 1, (chunk->count - pos - 1) * sizeof(LineRecord));
+    chunk->count--;
+    count--;
+    if (chunk->count == 0) {
+        delete chunk;
+        chunks.erase(chunks.begin() + c);
+        firstLines.erase(firstLines.begin() + c);
+    } else {
+        firstLines[c] = chunk->records[0].lineNumber;
+    }
+}
+
+void LineTable::clear() {
+    for (Chunk *chunk : chunks) {
+        delete chunk;
+    }
+    chunks.clear();
+    firstLines.clear();
+    count = 0;
+}
+
+int LineTable::size() {
+    return count;
+}
+
+bool LineTable::isEmpty() {
+    return count == 0;
+}
+
+LineTable::iterator LineTable::begin() {
+    return iterator(&chunks, 0, 0);
+}
+
+LineTable::iterator LineTable::end() {
+    return iterator(&chunks, chunks.size(), 0);
+}
+
+LineTable::iterator::iterator(const std::vector<Chunk *> *chunks, int chunk, int pos)
+        : chunks(chunks), chunk(chunk), pos(pos) {}
+
+LineRecord &LineTable::iterator::operator*() {
+    return (*chunks)[chunk]->records[pos];
+}
+
+LineRecord *LineTable::iterator::operator->() {
+    return &(*chunks)[chunk]->records[pos];
+}
+
+LineTable::iterator &LineTable::iterator::operator++() {
+    if (++pos == (*chunks)[chunk]->count) {
+        chunk++;
+        pos = 0;
+    }
+    return *this;
+}
+
+bool LineTable::iterator::operator!=(const iterator &other) {
+    return chunk != other.chunk || pos != other.pos;
+}
@@ -0,0 +1,191 @@
+/*
+ * File: linetable.h
+ * -----------------
+ * This interface exports the LineTable class, which keeps the lines of
+ * a BASIC program sorted by line number.
+ */
+
+#ifndef _linetable_h
+#define _linetable_h
+
+#include <vector>
+
+class Statement;
+
+/*
+ * Type: LineRecord
+ * ----------------
+ * Everything the program knows about one line, kept together so that
+ * a line costs a single small record instead of entries in several
+ * node-based containers.  The source text is not null-terminated; its
+ * storage and the statement are owned by the Program, not the table.
+ */
+
+struct LineRecord {
+    int lineNumber;
+    int length;           /* Length of the source text            */
+    char *text;           /* Source text, including the number    */
+    Statement *stmt;      /* Parsed statement, or nullptr         */
+};
+
+/*
+ * Class: LineTable
+ * ----------------
+ * A sorted sequence of LineRecords stored in fixed-size chunks.  Each
+ * chunk is a small sorted array, and a separate array holds the first
+ * line number of every chunk, so a lookup is two binary searches over
+ * contiguous memory.  Inserting or erasing a line only shifts records
+ * inside one chunk, and walking the lines in order touches the chunks
+ * one after another.
+ *
+ * Pointers to records stay valid until the next insert or erase.
+ */
+
+class LineTable {
+
+private:
+
+    struct Chunk;
+
+public:
+
+/*
+ * Class: LineTable::iterator
+ * --------------------------
+ * Visits the records in increasing order of line number:
+ *
+ *<pre>
+ *    for (LineRecord &rec : table) ...
+ *</pre>
+ */
+
+    class iterator {
+
+    public:
+
+        iterator(const std::vector<Chunk *> *chunks, int chunk, int pos);
+
+        LineRecord &operator*();
+
+        LineRecord *operator->();
+
+        iterator &operator++();
+
+        bool operator!=(const iterator &other);
+
+    private:
+
+        const std::vector<Chunk *> *chunks;
+        int chunk;
+        int pos;
+
+    };
+
+/*
+ * Constructor: LineTable
+ * Usage: LineTable table;
+ * -----------------------
+ * Creates an empty table.
+ */
+
+    LineTable();
+
+/*
+ * Destructor: ~LineTable
+ * Usage: usually implicit
+ * -----------------------
+ * Frees the chunks of the table.  The text and statements referred to
+ * by the records are left alone.
+ */
+
+    ~LineTable();
+
+    LineTable(const LineTable &) = delete;
+
+    LineTable &operator=(const LineTable &) = delete;
+
+/*
+ * Method: find
+ * Usage: LineRecord *rec = table.find(lineNumber);
+ * ------------------------------------------------
+ * Returns the record for the specified line, or nullptr if the table
+ * has no such line.
+ */
+
+    LineRecord *find(int lineNumber);
+
+/*
+ * Method: findNext
+ * Usage: LineRecord *rec = table.findNext(lineNumber);
+ * ----------------------------------------------------
+ * Returns the record of the first line whose number is larger than the
+ * specified one, or nullptr if there is none.
+ */
+
+    LineRecord *findNext(int lineNumber);
+
+/*
+ * Method: insert
+ * Usage: LineRecord *rec = table.insert(lineNumber);
+ * --------------------------------------------------
+ * Returns the record for the specified line, creating it in the right
+ * place if necessary.  A new record has no text and no statement.
+ */
+
+    LineRecord *insert(int lineNumber);
+
+/*
+ * Method: erase
+ * Usage: table.erase(lineNumber);
+ * -------------------------------
+ * Removes the record for the specified line, if there is one.  The
+ * caller is responsible for whatever the record referred to.
+ */
+
+    void erase(int lineNumber);
+
+/*
+ * Method: clear
+ * Usage: table.clear();
+ * ---------------------
+ * Removes every record from the table.
+ */
+
+    void clear();
+
+/*
+ * Methods: size, isEmpty
+ * Usage: int n = table.size();
+ *        if (table.isEmpty()) ...
+ * -------------------------------
+ * Return the number of lines in the table and whether it is zero.
+ */
+
+    int size();
+
+    bool isEmpty();
+
+/*
+ * Methods: begin, end
+ * Usage: for (LineRecord &rec : table) ...
+ * ----------------------------------------
+ * Return iterators over the records in line order.
+ */
+
+    iterator begin();
+
+    iterator end();
+
+private:
+
+    std::vector<Chunk *> chunks;
+
+    std::vector<int> firstLines;    /* First line number of each chunk */
+
+    int count;
+
+    int findChunk(int lineNumber);
+
+};
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * File: loader.cpp
+ * ----------------
+ * This file implements the script file loader.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "loader.hpp"
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#include <emmintrin.h>
+#define BASIC_SSE2_SCAN
+#endif
+
+MappedFile::MappedFile() : data(nullptr), size(0) {}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) munmap(data, size);
+}
+
+/*
+ * Implementation notes: open
+ * --------------------------
+ * An empty file cannot be mapped and needs nothing anyway.  If mmap
+ * fails for any other reason the file is read the ordinary way.
+ */
+
+bool MappedFile::open(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        if (info.st_size == 0) {
+            close(fd);
+            return true;
+        }
+        void *ptr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED) {
+            madvise(ptr, info.st_size, MADV_SEQUENTIAL);
+            data = (char *) ptr;
+            size = info.st_size;
+            close(fd);
+            return true;
+        }
+    }
+    char chunk[1 << 16];
+    while (true) {
+        ssize_t n = read(fd, chunk, sizeof chunk);
+        if (n < 0) {
+            close(fd);
+            return false;
+        }
+        if (n == 0) break;
+        contents.append(chunk, n);
+    }
+    close(fd);
+    return true;
+}
+
+std::string_view MappedFile::getText() {
+    if (data != nullptr) return std::string_view(data, size);
+    return contents;
+}
+
+/*
+ * Implementation notes: splitLines
+ * --------------------------------
+ * The SSE2 loop compares sixteen bytes with '\n' at once and turns the
+ * result into a bit mask, then takes the newlines out of the mask one
+ * at a time, so short lines cost a few instructions each instead of a
+ * call to memchr.  The tail of the text is scanned byte by byte.
+ */
+
+void splitLines(std::string_view text, std::vector<std::string_view> &lines) {
+    const char *start = text.data();
+    const char *end = start + text.size();
+    const char *p = start;
+#ifdef BASIC_SSE2_SCAN
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; p + 16 <= end; p += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *) p);
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline));
+        while (mask != 0) {
+            const char *nl = p + __builtin_ctz(mask);
+            lines.emplace_back(start, nl - start);
+            start = nl + 1;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; p < end; p++) {
+        if (*p == '\n') {
+            lines.emplace_back(start, p - start);
+            start = p + 1;
+        }
+    }
+    if (start < end) lines.emplace_back(start, end - start);
+}
@@ -0,0 +1,89 @@
+/*
+ * File: loader.h
+ * --------------
+ * This interface exports the pieces the interpreter uses to read a
+ * BASIC script from a file instead of from standard input.
+ */
+
+#ifndef _loader_h
+#define _loader_h
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Class: MappedFile
+ * -----------------
+ * The contents of a file, mapped into memory read-only so that they
+ * can be split into lines without copying.  Files that cannot be
+ * mapped, such as pipes, are read into memory instead.
+ */
+
+class MappedFile {
+
+public:
+
+/*
+ * Constructor: MappedFile
+ * Usage: MappedFile file;
+ * -----------------------
+ * Creates an object with no file open.
+ */
+
+    MappedFile();
+
+/*
+ * Destructor: ~MappedFile
+ * Usage: usually implicit
+ * -----------------------
+ * Unmaps the file.  Views returned by getText become invalid.
+ */
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+/*
+ * Method: open
+ * Usage: if (file.open(path)) ...
+ * -------------------------------
+ * Maps the named file, returning false if it cannot be read.
+ */
+
+    bool open(const std::string &path);
+
+/*
+ * Method: getText
+ * Usage: std::string_view text = file.getText();
+ * ----------------------------------------------
+ * Returns the contents of the file.
+ */
+
+    std::string_view getText();
+
+private:
+
+    char *data;
+
+    size_t size;
+
+    std::string contents;   /* Used when the file cannot be mapped */
+
+};
+
+/*
+ * Function: splitLines
+ * Usage: splitLines(text, lines);
+ * -------------------------------
+ * Appends the lines of text to lines, without their newline
+ * characters, exactly as repeated calls to getline would return them.
+ * The views point into text.  The newlines are found sixteen bytes at
+ * a time with SSE2 where it is available.
+ */
+
+void splitLines(std::string_view text, std::vector<std::string_view> &lines);
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * File: optimizer.cpp
+ * -------------------
+ * Implements the optimizer.h interface.
+ */
+
+#include <climits>
+#include "optimizer.hpp"
+#include "keyword.hpp"
+
+/*
+ * Function: foldConstants
+ * -----------------------
+ * Computes the value of left op right for two constant operands.
+ * Returns false if the operation must be left for run time, either
+ * because it reports an error there or because it overflows.
+ */
+
+static bool foldConstants(TokenKind op, int left, int right, int &result) {
+    switch (op) {
+        case TOK_PLUS:
+            return !__builtin_add_overflow(left, right, &result);
+        case TOK_MINUS:
+            return !__builtin_sub_overflow(left, right, &result);
+        case TOK_TIMES:
+            return !__builtin_mul_overflow(left, right, &result);
+        case TOK_DIVIDE:
+            if (right == 0 || (left == INT_MIN && right == -1)) return false;
+            result = left / right;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool isConstant(Expression *exp, int value) {
+    return exp->getType() == CONSTANT && ((ConstantExp *) exp)->getValue() == value;
+}
+
+/*
+ * Function: replaceWith
+ * ---------------------
+ * Detaches the subexpression keep from the compound node, frees the
+ * rest of the node and returns keep.
+ */
+
+static Expression *replaceWith(CompoundExp *exp, Expression *keep) {
+    if (exp->getLHS() == keep) exp->setLHS(nullptr);
+    if (exp->getRHS() == keep) exp->setRHS(nullptr);
+    delete exp;
+    return keep;
+}
+
+/*
+ * Implementation notes: simplifyExp
+ * ---------------------------------
+ * The tree is simplified bottom-up, so a node sees its operands in
+ * their final form.  The left-hand side of an assignment is never
+ * touched, since CompoundExp::eval checks that it is an identifier.
+ */
+
+Expression *simplifyExp(Expression *exp) {
+    if (exp->getType() != COMPOUND) return exp;
+    CompoundExp *compound = (CompoundExp *) exp;
+    TokenKind op = classifyToken(compound->getOp());
+    if (op != TOK_EQUALS) {
+        compound->setLHS(simplifyExp(compound->getLHS()));
+    }
+    compound->setRHS(simplifyExp(compound->getRHS()));
+    Expression *lhs = compound->getLHS();
+    Expression *rhs = compound->getRHS();
+    if (op == TOK_EQUALS) return compound;
+    if (lhs->getType() == CONSTANT && rhs->getType() == CONSTANT) {
+        int result;
+        if (foldConstants(op, ((ConstantExp *) lhs)->getValue(),
+                          ((ConstantExp *) rhs)->getValue(), result)) {
+            delete compound;
+            return new ConstantExp(result);
+        }
+        return compound;
+    }
+    switch (op) {
+        case TOK_PLUS:
+            if (isConstant(rhs, 0)) return replaceWith(compound, lhs);
+            if (isConstant(lhs, 0)) return replaceWith(compound, rhs);
+            break;
+        case TOK_MINUS:
+            if (isConstant(rhs, 0)) return replaceWith(compound, lhs);
+            break;
+        case TOK_TIMES:
+            if (isConstant(rhs, 1)) return replaceWith(compound, lhs);
+            if (isConstant(lhs, 1)) return replaceWith(compound, rhs);
+            break;
+        case TOK_DIVIDE:
+            if (isConstant(rhs, 1)) return replaceWith(compound, lhs);
+            break;
+        default:
+            break;
+    }
+    return compound;
+}
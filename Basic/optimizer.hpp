@@ -0,0 +1,32 @@
+/*
+ * File: optimizer.h
+ * -----------------
+ * This interface exports the simplification pass that the program
+ * runs over expression trees when a statement is installed.
+ */
+
+#ifndef _optimizer_h
+#define _optimizer_h
+
+#include "exp.hpp"
+
+/*
+ * Function: simplifyExp
+ * Usage: exp = simplifyExp(exp);
+ * ------------------------------
+ * Returns a tree equivalent to exp in which constant subexpressions
+ * have been folded and the identities x + 0, 0 + x, x - 0, x * 1,
+ * 1 * x and x / 1 have been reduced to x.  Negated literals, which the
+ * parser builds as 0 - k, collapse into a single constant.  Nodes that
+ * are no longer needed are freed, so the caller must replace its
+ * pointer with the result.
+ *
+ * Evaluating the result reports exactly the errors the original tree
+ * would: a division is only folded when its divisor is a nonzero
+ * constant, no operand that might be undefined is dropped, and an
+ * arithmetic result that would overflow is left for run time.
+ */
+
+Expression *simplifyExp(Expression *exp);
+
+#endif
@@ -0,0 +1,231 @@
+/*
+ * File: output.cpp
+ * ----------------
+ * This file implements the OutputSink class.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "output.hpp"
+
+#if defined(__linux__) && !defined(BASIC_NO_ZERO_COPY_OUTPUT)
+#define BASIC_ZERO_COPY_OUTPUT
+#endif
+
+static const size_t WRITE_CHUNK = 4096;
+
+/*
+ * Function: mapBuffer
+ * -------------------
+ * Returns fresh page-aligned anonymous memory, or nullptr.
+ */
+
+static char *mapBuffer(size_t size) {
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (ptr == MAP_FAILED) ? nullptr : (char *) ptr;
+}
+
+OutputSink::OutputSink(int fd) : fd(fd), policy(FLUSH_ON_INPUT | FLUSH_ON_ERROR), mode(OUTPUT_WRITE),
+                                 buffer(nullptr), capacity(CAPACITY), used(0) {
+#ifdef BASIC_ZERO_COPY_OUTPUT
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISFIFO(info.st_mode)) {
+        buffer = mapBuffer(CAPACITY);
+        if (buffer != nullptr) mode = OUTPUT_PIPE;
+    }
+#endif
+    if (mode == OUTPUT_WRITE) buffer = new char[CAPACITY];
+}
+
+OutputSink::~OutputSink() {
+    flush();
+    switch (mode) {
+        case OUTPUT_WRITE:
+            delete[] buffer;
+            break;
+        case OUTPUT_PIPE:
+            munmap(buffer, capacity);
+            break;
+    }
+}
+
+/*
+ * Implementation notes: write
+ * ---------------------------
+ * Text is copied in pieces that fit in the buffer, so text longer than
+ * the whole buffer simply drains it more than once.  Room is only made
+ * for WRITE_CHUNK bytes at a time, so that long text does not drain a
+ * buffer that still has space in it.
+ */
+
+void OutputSink::write(std::string_view text) {
+    while (!text.empty()) {
+        reserve(std::min(text.size(), WRITE_CHUNK));
+        size_t n = std::min(text.size(), capacity - used);
+        std::memcpy(buffer + used, text.data(), n);
+        used += n;
+        text.remove_prefix(n);
+    }
+}
+
+void OutputSink::writeInt(int value) {
+    reserve(16);
+    used = std::to_chars(buffer + used, buffer + capacity, value).ptr - buffer;
+}
+
+void OutputSink::endLine() {
+    reserve(1);
+    buffer[used++] = '\n';
+    if (policy & FLUSH_ON_NEWLINE) flush();
+}
+
+void OutputSink::notify(FlushEvent event) {
+    if (policy & event) flush();
+}
+
+void OutputSink::flush() {
+    if (used > 0) drain();
+}
+
+/*
+ * Implementation notes: flushFromSignal
+ * -------------------------------------
+ * The signal may have interrupted any method of the sink.  Every one
+ * of them keeps buffer and used describing text that has not been
+ * handed over yet, and sets buffer to nullptr while it is not valid
+ * memory, so write(2) on them is all that is needed and all that is
+ * safe in a signal handler.
+ */
+
+void OutputSink::flushFromSignal() {
+    if (buffer != nullptr && used > 0) writeBuffer(buffer, used);
+}
+
+void OutputSink::setFlushPolicy(int policy) {
+    this->policy = policy;
+}
+
+int OutputSink::getFlushPolicy() {
+    return policy;
+}
+
+OutputMode OutputSink::getMode() {
+    return mode;
+}
+
+void OutputSink::reserve(size_t size) {
+    if (used + size > capacity) drain();
+}
+
+/*
+ * Implementation notes: drain
+ * ---------------------------
+ * Empties a full buffer.  A pipe gets the pages of the buffer and the
+ * sink moves on to new memory, since the pipe reads the old pages when
+ * its reader gets to them.
+ */
+
+void OutputSink::drain() {
+    switch (mode) {
+        case OUTPUT_WRITE:
+            writeBuffer(buffer, used);
+            used = 0;
+            break;
+        case OUTPUT_PIPE:
+            if (!spliceBuffer()) fallBack();
+            break;
+    }
+}
+
+/*
+ * Implementation notes: writeBuffer
+ * ---------------------------------
+ * A write interrupted by a signal is retried.  Any other failure, such
+ * as a closed pipe, discards the data, because there is nobody left to
+ * report the error to.
+ */
+
+void OutputSink::writeBuffer(const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        size -= n;
+    }
+}
+
+/*
+ * Implementation notes: spliceBuffer
+ * ----------------------------------
+ * If vmsplice is refused, the rest of the buffer is written normally
+ * before reporting the failure, so nothing is lost or reordered.  The
+ * buffer is emptied before its pages are written or given up, so that
+ * flushFromSignal never sees them twice or after they are unmapped.
+ */
+
+bool OutputSink::spliceBuffer() {
+#ifdef BASIC_ZERO_COPY_OUTPUT
+    struct iovec iov = {buffer, used};
+    while (iov.iov_len > 0) {
+        ssize_t n = vmsplice(fd, &iov, 1, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            used = 0;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            writeBuffer((const char *) iov.iov_base, iov.iov_len);
+            return false;
+        }
+        iov.iov_base = (char *) iov.iov_base + n;
+        iov.iov_len -= n;
+    }
+    char *pages = buffer;
+    used = 0;
+    buffer = nullptr;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    munmap(pages, capacity);
+    buffer = mapBuffer(capacity);
+    return buffer != nullptr;
+#else
+    return false;
+#endif
+}
+
+/*
+ * Implementation notes: fallBack
+ * ------------------------------
+ * Switches the sink to plain writes after the zero-copy method failed.
+ * Whatever was already handed over is in place, so the sink starts
+ * again with an empty buffer.
+ */
+
+void OutputSink::fallBack() {
+    if (mode == OUTPUT_PIPE && buffer != nullptr) {
+        char *pages = buffer;
+        size_t size = used;
+        used = 0;
+        buffer = nullptr;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        writeBuffer(pages, size);
+        munmap(pages, capacity);
+    }
+    mode = OUTPUT_WRITE;
+    buffer = new char[CAPACITY];
+    capacity = CAPACITY;
+    used = 0;
+}
+
+OutputSink &standardOutput() {
+    static OutputSink sink(STDOUT_FILENO);
+    return sink;
+}
@@ -0,0 +1,198 @@
+/*
+ * File: output.h
+ * --------------
+ * This interface exports the OutputSink class, through which the
+ * interpreter writes everything it prints.
+ */
+
+#ifndef _output_h
+#define _output_h
+
+#include <cstddef>
+#include <string_view>
+
+/*
+ * Type: FlushEvent
+ * ----------------
+ * The events on which a sink can be told to flush.  A flush policy is
+ * a bitwise combination of these values:
+ *
+ *   FLUSH_ON_INPUT   -- before the interpreter waits for INPUT
+ *   FLUSH_ON_ERROR   -- after an error message has been written
+ *   FLUSH_ON_NEWLINE -- at the end of every line, as a terminal wants
+ *
+ * A sink also flushes whenever its buffer fills up and when it is
+ * destroyed, which includes a call to exit.  The interpreter flushes
+ * standard output itself on the fatal paths that skip destructors.
+ */
+
+enum FlushEvent {
+    FLUSH_ON_INPUT = 1,
+    FLUSH_ON_ERROR = 2,
+    FLUSH_ON_NEWLINE = 4
+};
+
+/*
+ * Type: OutputMode
+ * ----------------
+ * How a sink gets its buffer to the descriptor:
+ *
+ *   OUTPUT_WRITE -- copy it with write(2); works for anything
+ *   OUTPUT_PIPE  -- hand its pages to a pipe with vmsplice(2)
+ *
+ * The second is only available on Linux.
+ */
+
+enum OutputMode {
+    OUTPUT_WRITE, OUTPUT_PIPE
+};
+
+/*
+ * Class: OutputSink
+ * -----------------
+ * A buffered writer on a file descriptor.  Text and integers are
+ * copied into a large buffer, integers formatted with std::to_chars,
+ * and the buffer only goes to the descriptor when the flush policy
+ * asks for it, so a program that prints many values makes a handful
+ * of system calls instead of one per line.
+ *
+ * The sink picks the cheapest way to move its buffer that fits the
+ * descriptor.  If stdout is a pipe, whole buffers of pages are spliced
+ * into it without being copied; anything else, regular files included,
+ * gets plain write calls, which keep the file no longer than what has
+ * been written and share its offset with stderr and other writers.
+ * If splicing fails, the sink switches to write calls for good.
+ */
+
+class OutputSink {
+
+public:
+
+/*
+ * Constructor: OutputSink
+ * Usage: OutputSink sink(fd);
+ * ---------------------------
+ * Creates a sink that writes to the file descriptor fd.  The initial
+ * policy flushes on INPUT and on errors.
+ */
+
+    explicit OutputSink(int fd);
+
+/*
+ * Destructor: ~OutputSink
+ * Usage: usually implicit
+ * -----------------------
+ * Flushes whatever is left in the buffer.
+ */
+
+    ~OutputSink();
+
+    OutputSink(const OutputSink &) = delete;
+
+    OutputSink &operator=(const OutputSink &) = delete;
+
+/*
+ * Methods: write, writeInt, endLine
+ * Usage: sink.write("LINE NUMBER ERROR");
+ *        sink.writeInt(value);
+ *        sink.endLine();
+ * ---------------------------------------
+ * Append text, the decimal form of an integer or a newline to the
+ * buffer.  endLine flushes if the policy includes FLUSH_ON_NEWLINE.
+ */
+
+    void write(std::string_view text);
+
+    void writeInt(int value);
+
+    void endLine();
+
+/*
+ * Method: notify
+ * Usage: sink.notify(FLUSH_ON_INPUT);
+ * -----------------------------------
+ * Reports an event to the sink, which flushes if its policy says so.
+ */
+
+    void notify(FlushEvent event);
+
+/*
+ * Method: flush
+ * Usage: sink.flush();
+ * --------------------
+ * Writes out the buffer regardless of the policy.
+ */
+
+    void flush();
+
+/*
+ * Method: flushFromSignal
+ * Usage: sink.flushFromSignal();
+ * ------------------------------
+ * Writes out the buffer with nothing but write(2), which makes it
+ * safe to call from a signal handler that interrupted the sink.  The
+ * sink must not be used any more afterwards.
+ */
+
+    void flushFromSignal();
+
+/*
+ * Methods: setFlushPolicy, getFlushPolicy
+ * Usage: sink.setFlushPolicy(FLUSH_ON_INPUT | FLUSH_ON_ERROR);
+ *        int policy = sink.getFlushPolicy();
+ * ------------------------------------------------------------
+ * Set and return the combination of FlushEvents the sink flushes on.
+ */
+
+    void setFlushPolicy(int policy);
+
+    int getFlushPolicy();
+
+/*
+ * Method: getMode
+ * Usage: OutputMode mode = sink.getMode();
+ * ----------------------------------------
+ * Returns the method the sink currently uses to write its output.
+ */
+
+    OutputMode getMode();
+
+private:
+
+    static const size_t CAPACITY = 1 << 16;
+
+    int fd;
+
+    int policy;
+
+    OutputMode mode;
+
+    char *buffer;
+
+    size_t capacity;
+
+    size_t used;
+
+    void reserve(size_t size);
+
+    void drain();
+
+    void writeBuffer(const char *data, size_t size);
+
+    bool spliceBuffer();
+
+    void fallBack();
+
+};
+
+/*
+ * Function: standardOutput
+ * Usage: standardOutput().write(text);
+ * ------------------------------------
+ * Returns the sink for standard output.  Nothing else may write to
+ * standard output, since the sink bypasses cout and stdio.
+ */
+
+OutputSink &standardOutput();
+
+#endif
@@ -5,6 +5,7 @@
  */
 
 #include "parser.hpp"
+#include "keyword.hpp"
 #include "Utils/error.hpp"
 #include "Utils/strlib.hpp"
 
@@ -36,15 +37,16 @@ Expression *parseExp(TokenScanner &scanner) {
 
 Expression *readE(TokenScanner &scanner, int prec) {
     Expression *exp = readT(scanner);
-    std::string token;
+    TokenView token;
     while (true) {
-        token = scanner.nextToken();
-        int newPrec = precedence(token);
+        token = scanner.nextTokenView();
+        int newPrec = precedence(token.text);
         if (newPrec <= prec) break;
+        char op = token.text[0];
         Expression *rhs = readE(scanner, newPrec);
-        exp = new CompoundExp(token, exp, rhs);
+        exp = new CompoundExp(op, exp, rhs);
     }
-    scanner.saveToken(token);
+    scanner.saveToken(token.text);
     return exp;
 }
 
@@ -56,14 +58,14 @@ Expression *readE(TokenScanner &scanner, int prec) {
  */
 
 Expression *readT(TokenScanner &scanner) {
-    std::string token = scanner.nextToken();
-    TokenType type = scanner.getTokenType(token);
-    if (type == WORD) return new IdentifierExp(token);
-    if (type == NUMBER) return new ConstantExp(stringToInteger(token));
-    if (token == "-") return new CompoundExp(token, new ConstantExp(0), readE(scanner));
-    if (token != "(") error("Illegal term in expression");
+    TokenView token = scanner.nextTokenView();
+    if (token.type == WORD) return new IdentifierExp(token.text);
+    if (token.type == NUMBER) return new ConstantExp(stringToInteger(std::string(token.text)));
+    TokenKind kind = classifyToken(token.text);
+    if (kind == TOK_MINUS) return new CompoundExp('-', new ConstantExp(0), readE(scanner));
+    if (kind != TOK_LPAREN) error("Illegal term in expression");
     Expression *exp = readE(scanner);
-    if (scanner.nextToken() != ")") {
+    if (classifyToken(scanner.nextTokenView().text) != TOK_RPAREN) {
         error("Unbalanced parentheses in expression");
     }
     return exp;
@@ -72,13 +74,37 @@ Expression *readT(TokenScanner &scanner) {
 /*
  * Implementation notes: precedence
  * --------------------------------
- * This function checks the token against each of the defined operators
- * and returns the appropriate precedence value.
+ * This function classifies the token and returns the precedence value
+ * for its kind.
  */
 
-int precedence(std::string token) {
-    if (token == "=") return 1;
-    if (token == "+" || token == "-") return 2;
-    if (token == "*" || token == "/") return 3;
-    return 0;
+int precedence(std::string_view token) {
+    switch (classifyToken(token)) {
+        case TOK_EQUALS:
+            return 1;
+        case TOK_PLUS:
+        case TOK_MINUS:
+            return 2;
+        case TOK_TIMES:
+        case TOK_DIVIDE:
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Implementation notes: resolveVariables
+ * --------------------------------------
+ * This function is a straightforward recursive walk over the tree.
+ */
+
+void resolveVariables(Expression *exp, EvalState &state) {
+    if (exp->getType() == IDENTIFIER) {
+        IdentifierExp *var = (IdentifierExp *) exp;
+        var->setSlot(state.getSlot(var->getName()));
+    } else if (exp->getType() == COMPOUND) {
+        resolveVariables(((CompoundExp *) exp)->getLHS(), state);
+        resolveVariables(((CompoundExp *) exp)->getRHS(), state);
+    }
 }
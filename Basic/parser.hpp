@@ -8,6 +8,7 @@
 #define _parser_h
 
 #include <string>
+#include <string_view>
 #include "exp.hpp"
 
 #include "Utils/tokenScanner.hpp"
@@ -53,6 +54,17 @@ Expression *readT(TokenScanner &scanner);
  * is not an operator, precedence returns 0.
  */
 
-int precedence(std::string token);
+int precedence(std::string_view token);
+
+/*
+ * Function: resolveVariables
+ * Usage: resolveVariables(exp, state);
+ * ------------------------------------
+ * Walks a parsed expression and assigns every identifier its slot in
+ * the evaluation state, so that evaluating the tree never has to look
+ * a variable up by name.
+ */
+
+void resolveVariables(Expression *exp, EvalState &state);
 
 #endif
@@ -8,7 +8,10 @@
  * the performance guarantees specified in the assignment.
  */
 
+#include <cstring>
+#include <iostream>
 #include "program.hpp"
+#include "output.hpp"
 #include "Utils/error.hpp"
 #include "statement.hpp"
 
@@ -16,39 +19,47 @@
 void Program::clear() {
     // Replace this stub with your own code
     //todo
-    for (auto& pair: parsedStatements) {
-        delete pair.second;
+    for (LineRecord &rec : lines) {
+        delete rec.stmt;
     }
-    sourceLines.clear();
-    parsedStatements.clear();//只删除，不释放内存
-    lineNumbers.clear();
+    lines.clear();
     variables.clear();
+    image.clear();
+    imageLines.clear();
+    imageStatements.clear();
+    lineIndex.build({}, {});
+    graph.build(nullptr, 0);
+    traces.reset(nullptr, 0);
+    native.clear();
+    arena.reset();
 }
 
-void Program::addSourceLine(int lineNumber, std::string line) {
+/*
+ * Implementation notes: addSourceLine
+ * -----------------------------------
+ * The text is copied into the arena next to the statements, so a line
+ * needs no allocation of its own beyond its bytes.  Replacing the text
+ * gives the old copy back to the arena.
+ */
+
+void Program::addSourceLine(int lineNumber, std::string_view line) {
     // Replace this stub with your own code
     //todo
-    if (sourceLines.find(lineNumber) != sourceLines.end()) {
-        sourceLines[lineNumber] = line;
-    }
-    else {
-        sourceLines.insert({lineNumber, line});
-        lineNumbers.insert(lineNumber); 
-    }
+    LineRecord *rec = lines.insert(lineNumber);
+    NodeArena::deallocate(rec->text);
+    rec->text = (char *) arena.allocateBuffer(line.size());
+    rec->length = line.size();
+    std::memcpy(rec->text, line.data(), line.size());
 }
 
 void Program::removeSourceLine(int lineNumber) {
     // Replace this stub with your own code
     //todo
-    auto it = sourceLines.find(lineNumber);
-    if (it != sourceLines.end()) {
-        sourceLines.erase(it);
-        lineNumbers.erase(lineNumber);
-        auto stmtIt = parsedStatements.find(lineNumber);
-        if (stmtIt != parsedStatements.end()) {
-            delete stmtIt->second;
-            parsedStatements.erase(stmtIt);
-        }
+    LineRecord *rec = lines.find(lineNumber);
+    if (rec != nullptr) {
+        delete rec->stmt;
+        NodeArena::deallocate(rec->text);
+        lines.erase(lineNumber);
     }
     else {
         error("LINE NUMBER ERROR ");
@@ -58,9 +69,9 @@ void Program::removeSourceLine(int lineNumber) {
 std::string Program::getSourceLine(int lineNumber) {
     // Replace this stub with your own code
     //todo
-    auto it = sourceLines.find(lineNumber);
-    if (it != sourceLines.end()) {
-        return it->second; 
+    LineRecord *rec = lines.find(lineNumber);
+    if (rec != nullptr) {
+        return std::string(rec->text, rec->length);
     } else {
         error("LINE NUMBER ERROR ");
         return "";
@@ -70,50 +81,120 @@ std::string Program::getSourceLine(int lineNumber) {
 void Program::setParsedStatement(int lineNumber, Statement *stmt) {
     // Replace this stub with your own code
     //todo
-    if(lineNumbers.find(lineNumber) == lineNumbers.end()) {
+    LineRecord *rec = lines.find(lineNumber);
+    if (rec == nullptr) {
         error("SYNTAX ERROR");
     }
-    if(parsedStatements[lineNumber] != nullptr) {
-        delete parsedStatements[lineNumber];
-    }
-    parsedStatements[lineNumber] = stmt;
+    stmt->optimize();
+    delete rec->stmt;
+    rec->stmt = stmt;
 }
 
 Statement *Program::getParsedStatement(int lineNumber) {
    // Replace this stub with your own code
    //todo
-   auto it = parsedStatements.find(lineNumber);
-    if (it != parsedStatements.end()) {
-        return it->second; 
-    } else {
-        return nullptr; 
-    }
+   LineRecord *rec = lines.find(lineNumber);
+   return (rec != nullptr) ? rec->stmt : nullptr;
 }
 
 int Program::getFirstLineNumber() {
     // Replace this stub with your own code
     //todo
-    if (lineNumbers.empty()) {
+    if (lines.isEmpty()) {
         return -1;  
     }
     else {
-        return *lineNumbers.begin();
+        return lines.begin()->lineNumber;
     }
 }
 
 int Program::getNextLineNumber(int lineNumber) {
     // Replace this stub with your own code
     //todo
-    auto it = lineNumbers.find(lineNumber); 
-    if (it != lineNumbers.end()) {
-        it++;
-        if (it != lineNumbers.end()) return *it;  
-        else return -1;
+    LineRecord *rec = lines.findNext(lineNumber);
+    return (rec != nullptr) ? rec->lineNumber : -1;
+}
+
+void Program::listProgram() {
+    OutputSink &out = standardOutput();
+    for (LineRecord &rec : lines) {
+        out.write(std::string_view(rec.text, rec.length));
+        out.endLine();
+    }
+}
+
+/*
+ * Implementation notes: link
+ * --------------------------
+ * The image only holds lines that do something when run, so RUN never
+ * has to skip lines without a parsed statement or REM lines.  Every
+ * line is entered in lineIndex with the image index of the first
+ * statement at or after it.  Each statement then resolves its own jump
+ * target through findImageIndex and is lowered into its record, which
+ * also points back at it so that runImage can run cold lines through
+ * execute.  The image is divided into basic blocks, the traces of
+ * the previous image are discarded and room is made for new ones, and
+ * the blocks of lines that stayed hot since the last RUN are compiled
+ * again right away.  With the JIT enabled the finished image is then
+ * translated; if that fails, run falls back to the interpreter.
+ */
+
+void Program::link() {
+    image.clear();
+    imageLines.clear();
+    imageStatements.clear();
+    std::vector<int> indexLines;
+    std::vector<int> indexTargets;
+    indexLines.reserve(lines.size());
+    indexTargets.reserve(lines.size());
+    for (LineRecord &rec : lines) {
+        indexLines.push_back(rec.lineNumber);
+        indexTargets.push_back(imageStatements.size());
+        if (rec.stmt != nullptr && rec.stmt->getType() != REM) {
+            imageStatements.push_back(rec.stmt);
+            imageLines.push_back(rec.lineNumber);
+        }
+    }
+    lineIndex.build(indexLines, indexTargets);
+    image.resize(imageStatements.size() + 1);
+    for (size_t i = 0; i < imageStatements.size(); i++) {
+        imageStatements[i]->link(*this);
+        imageStatements[i]->lower(image[i]);
+        image[i].stmt = imageStatements[i];
+    }
+    image.back() = {STMT_HALT, 0, -1, -1, nullptr, nullptr, nullptr, nullptr, nullptr, 0, 0, -1, -1};
+    graph.build(image.data(), imageStatements.size());
+    if (graphDumpEnabled) graph.dump(*this, std::cerr);
+    traces.reset(image.data(), image.size());
+    compileBlocks(image.data(), *this);
+    native.clear();
+    if (jitEnabled) native.compile(image.data(), image.size());
+}
+
+int Program::getImageSize() {
+    return imageStatements.size();
+}
+
+const StatementRecord *Program::getImage() {
+    return image.data();
+}
+
+int Program::getImageLineNumber(int index) {
+    return imageLines[index];
+}
+
+void Program::run(EvalState &state) {
+    if (native.isReady()) {
+        native.run(state);
     } else {
-        return -1; 
+        runImage(image.data(), *this, state);
     }
 }
 
+int Program::findImageIndex(int lineNumber) {
+    return lineIndex.find(lineNumber);
+}
+
 //more func to add
 //todo
 int Program::getVariable(std::string vname) {
@@ -134,22 +215,10 @@ bool Program::if_exist(std::string vname) {
 }
 
 bool Program::check_line(int check_linenumber) {
-    return (lineNumbers.find(check_linenumber) != lineNumbers.end());
+    return lines.find(check_linenumber) != nullptr;
 }
 
 void Program::setvariable(std::string varname, int value) {
     variables.insert({varname, value});
 }
 
-void Program::gotoLine(int x) {
-    if(lineNumbers.find(x) != lineNumbers.end()) currentLineNumber = x;
-    else error("LINE NUMBER ERROR");
-}
-
-void Program::goto_line(int goto_number) {
-    currentLineNumber = goto_number;
-}
-
-int Program::get_cur_linenumber() {
-    return currentLineNumber;
-}
\ No newline at end of file
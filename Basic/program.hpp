@@ -9,9 +9,16 @@
 #define _program_h
 
 #include <string>
-#include <set>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 #include "statement.hpp"
+#include "arena.hpp"
+#include "linetable.hpp"
+#include "lineindex.hpp"
+#include "jit.hpp"
+#include "trace.hpp"
+#include "cfg.hpp"
 
 class Statement;
 
@@ -26,6 +33,9 @@ class Statement;
  *
  * 2. The parsed representation of that statement, which is a
  *    pointer to a Statement.
+ *
+ * Both live in a single LineRecord of a sorted LineTable, and the
+ * text of the source lines is kept in the program's arena.
  */
 
 class Program {
@@ -39,7 +49,7 @@ public:
  * Constructs an empty BASIC program.
  */
 
-    Program(): currentLineNumber(0) {}
+    Program() {}
 
 /*
  * Destructor: ~Program
@@ -49,8 +59,8 @@ public:
  */
 
     ~Program() {
-        for (auto& pairx : parsedStatements) {
-            delete pairx.second;
+        for (LineRecord &rec : lines) {
+            delete rec.stmt;
         }
     }
 
@@ -74,7 +84,7 @@ public:
  * program in the correct sequence.
  */
 
-    void addSourceLine(int lineNumber, std::string line);
+    void addSourceLine(int lineNumber, std::string_view line);
 
 /*
  * Method: removeSourceLine
@@ -105,7 +115,9 @@ public:
  * Adds the parsed representation of the statement to the statement
  * at the specified line number.  If no such line exists, this
  * method raises an error.  If a previous parsed representation
- * exists, the memory for that statement is reclaimed.
+ * exists, the memory for that statement is reclaimed.  Installing
+ * a statement runs its optimize pass, which simplifies constant
+ * subexpressions once instead of on every execution.
  */
 
     void setParsedStatement(int lineNumber, Statement *stmt);
@@ -142,9 +154,105 @@ public:
 
     int getNextLineNumber(int lineNumber);
 
+/*
+ * Method: link
+ * Usage: program.link();
+ * ----------------------
+ * Builds the program image executed by RUN: a contiguous array of
+ * statement records in line order, with every GOTO and IF target
+ * resolved to an index into that array.  The image stays valid until
+ * the program is next edited.
+ */
+
+    void link();
+
+/*
+ * Method: getImageSize
+ * Usage: int n = program.getImageSize();
+ * --------------------------------------
+ * Returns the number of records in the linked program image.
+ */
+
+    int getImageSize();
+
+/*
+ * Method: getImage
+ * Usage: const StatementRecord *image = program.getImage();
+ * ---------------------------------------------------------
+ * Returns the records of the linked program image, which are followed
+ * by a STMT_HALT sentinel record.
+ */
+
+    const StatementRecord *getImage();
+
+/*
+ * Method: getImageLineNumber
+ * Usage: int lineNumber = program.getImageLineNumber(index);
+ * ----------------------------------------------------------
+ * Returns the line number of the statement at the given image index.
+ */
+
+    int getImageLineNumber(int index);
+
+/*
+ * Method: findImageIndex
+ * Usage: int index = program.findImageIndex(lineNumber);
+ * ------------------------------------------------------
+ * Returns the image index at which execution continues when control
+ * is transferred to the specified line, or -1 if the program has no
+ * such line.  Lines without a parsed statement are skipped over.
+ * Only valid after link, which builds the index this consults.
+ */
+
+    int findImageIndex(int lineNumber);
+
+/*
+ * Method: getArena
+ * Usage: ArenaScope scope(program.getArena());
+ * --------------------------------------------
+ * Returns the arena that holds the parsed statements of this program.
+ * Statements and expressions created while the arena is current are
+ * allocated from it; clear releases the whole arena at once.
+ */
+
+    NodeArena &getArena() {
+        return arena;
+    }
+
+/*
+ * Method: getGraph
+ * Usage: ControlFlowGraph &graph = program.getGraph();
+ * ----------------------------------------------------
+ * Returns the basic blocks of the linked image, which link builds.
+ */
+
+    ControlFlowGraph &getGraph() {
+        return graph;
+    }
+
+/*
+ * Method: getTraces
+ * Usage: TraceCache &traces = program.getTraces();
+ * ------------------------------------------------
+ * Returns the traces that runImage has recorded for the hot loops of
+ * the linked image.  link discards them.
+ */
+
+    TraceCache &getTraces() {
+        return traces;
+    }
+
+/*
+ * Method: listProgram
+ * Usage: program.listProgram();
+ * -----------------------------
+ * Writes every source line to standard output in line-number order.
+ */
+
+    void listProgram();
+
     //more func to add
     //todo
-    void listProgram();
     
     int getVariable(std::string vname);
      
@@ -154,61 +262,76 @@ public:
 
     void setvariable(std::string varname, int value);
 
-    void gotoLine(int x);
-    //判断是否END
-    bool if_end() {
-        return if_end1;
+    bool check_line(int check_linenumber);
+
+    bool if_empty() {
+        return lines.isEmpty();
     }
 
-    bool check_line(int check_linenumber);
+/*
+ * Method: run
+ * Usage: program.run(state);
+ * --------------------------
+ * Executes the linked program image until it ends, as native code if
+ * the JIT is enabled and could translate the image, and with the
+ * interpreter otherwise.
+ */
 
-    void goto_line(int goto_number);
+    void run(EvalState &state);
 
-    int get_cur_linenumber();
+/*
+ * Method: setJitEnabled
+ * Usage: program.setJitEnabled(true);
+ * -----------------------------------
+ * Turns translation of the image into native code at link time on or
+ * off.  It is off by default.
+ */
 
-    bool check_jump() {
-        return if_jump;
-    }
-    
-    void jump() {
-        if_jump = true;
+    void setJitEnabled(bool enabled) {
+        jitEnabled = enabled;
     }
 
-    void not_jump() {
-        if_jump = false;
-    }
+/*
+ * Method: setGraphDumpEnabled
+ * Usage: program.setGraphDumpEnabled(true);
+ * -----------------------------------------
+ * Makes link write the basic blocks of the image to standard error
+ * every time it runs, for debugging.  It is off by default.
+ */
 
-    bool if_empty() {
-        return lineNumbers.empty();
-    }
-    void endprogram() {
-        if_end1 = true;
-    }
-    void run() {
-        if_end1 = false;
+    void setGraphDumpEnabled(bool enabled) {
+        graphDumpEnabled = enabled;
     }
 
 private:
-    // 存储源代码行
-    std::unordered_map<int, std::string> sourceLines;
-    
-    // 存储每行的解析语句
-    std::unordered_map<int, Statement*> parsedStatements;
-    
-    // 存储程序中所有的行号
-    std::set<int> lineNumbers;
+    // 按行号排序存储每一行的源代码和解析语句
+    LineTable lines;
     
     // 存储程序的变量
     std::unordered_map<std::string, int> variables;
     
-    // 程序的当前执行行号
-    int currentLineNumber;
+    // 存放所有语句和表达式结点的内存池
+    NodeArena arena;
 
-    //判断是否通过GOTO或者IF改变了行号
-    bool if_jump = false;
-    //todo
+    // RUN 时按行号顺序排列的语句记录、对应的语句及其行号
+    std::vector<StatementRecord> image;
+    std::vector<Statement*> imageStatements;
+    std::vector<int> imageLines;
+
+    // 行号到 image 下标的索引，由 link 建立
+    LineIndex lineIndex;
+
+    // image 划分成的基本块，由 link 建立
+    ControlFlowGraph graph;
+    bool graphDumpEnabled = false;
+
+    // RUN 时为热循环录制的 trace，由 link 清空
+    TraceCache traces;
+
+    // image 翻译成的机器码，仅在启用 JIT 时由 link 生成
+    NativeCode native;
+    bool jitEnabled = false;
 
-    bool if_end1 = false;
 };
 
 #endif
@@ -8,15 +8,381 @@
  */
 
 #include "statement.hpp"
+#include "arena.hpp"
 #include "exp.hpp"
 #include "parser.hpp"
+#include "optimizer.hpp"
 #include "program.hpp"
+#include "trace.hpp"
+#include "cfg.hpp"
+#include "output.hpp"
 #include "Utils/error.hpp"
+#include "Utils/strlib.hpp"
+#include <cctype>
+#include <cstdlib>
 #include <iostream>
 #include <stdexcept>
 
 /* Implementation of the Statement class */
 
+/*
+ * Function: evaluate
+ * ------------------
+ * Evaluates an expression owned by a statement.  When the interpreter
+ * is built with BASIC_BYTECODE the compiled form is used once the line
+ * has been promoted; until then, and in builds without bytecode, the
+ * tree is walked directly.
+ */
+
+static int evaluate(Expression *exp, ExpCode &code, EvalState &state) {
+#ifdef BASIC_BYTECODE
+    if (!code.isEmpty()) return code.eval(state);
+#endif
+    return exp->eval(state);
+}
+
+/*
+ * Function: evaluateHot
+ * ---------------------
+ * Evaluates an expression of a promoted line, whose compiled form is
+ * known to exist when bytecode is enabled.
+ */
+
+static inline int evaluateHot(Expression *exp, ExpCode &code, EvalState &state) {
+#ifdef BASIC_BYTECODE
+    return code.eval(state);
+#else
+    return exp->eval(state);
+#endif
+}
+
+/*
+ * Function: simplify
+ * ------------------
+ * Simplifies an expression owned by a statement.  Only a compound tree
+ * can change.  The compiled form is built later, by promote.
+ */
+
+static void simplify(Expression *&exp) {
+    if (exp == nullptr || exp->getType() != COMPOUND) return;
+    exp = simplifyExp(exp);
+}
+
+/*
+ * Function: prepare
+ * -----------------
+ * Resolves the variables of an expression to slots.
+ */
+
+static void prepare(Expression *exp, EvalState &state) {
+    if (exp == nullptr) return;
+    resolveVariables(exp, state);
+}
+
+/*
+ * Function: compile
+ * -----------------
+ * Builds the compiled form of an expression when bytecode is enabled.
+ */
+
+static void compile(Expression *exp, ExpCode &code) {
+#ifdef BASIC_BYTECODE
+    if (exp != nullptr) code.compile(exp);
+#endif
+}
+
+/*
+ * Constant: HOT_THRESHOLD
+ * -----------------------
+ * The number of times a line runs in the cold tier before it is
+ * promoted.  Compiling an expression costs about as much as walking
+ * its tree a few times, so lines that run only once or twice, which
+ * is most of a short program, are never compiled at all.
+ */
+
+static const int HOT_THRESHOLD = 16;
+
+/*
+ * Function: startCold
+ * -------------------
+ * Puts a record in the cold tier if its expression has not been
+ * compiled yet.  The room for the bytecode is reserved here, while the
+ * program is being linked, so that promoting the line while it runs
+ * allocates nothing.
+ */
+
+static void startCold(StatementRecord &rec, Expression *exp, ExpCode &code) {
+#ifdef BASIC_BYTECODE
+    if (exp == nullptr || !code.isEmpty()) return;
+    code.reserve(exp);
+    rec.countdown = HOT_THRESHOLD;
+#endif
+}
+
+/*
+ * Function: compare
+ * -----------------
+ * Applies the relational operator of an IF statement.
+ */
+
+static bool compare(int left, char op, int right) {
+    switch (op) {
+        case '=': return left == right;
+        case '<': return left < right;
+        case '>': return left > right;
+        default: return false;
+    }
+}
+
+/*
+ * Function: readInput
+ * -------------------
+ * Prompts for a number until a valid one is entered and stores it in
+ * the variable slot.  The whole line must be the number, without any
+ * surrounding blanks.  End of input terminates the interpreter.
+ */
+
+void readInput(int slot, EvalState &state) {
+    std::string input;
+    while (true) {
+        OutputSink &out = standardOutput();
+        out.write(" ? ");
+        out.notify(FLUSH_ON_INPUT);
+        if (!std::getline(std::cin, input)) {
+            exit(0);
+        }
+        int value;
+        if (parseInteger(input, value) == INTEGER_OK) {
+            state.setValue(slot, value);
+            return;
+        }
+        out.write("INVALID NUMBER");
+        out.endLine();
+    }
+}
+
+/*
+ * Function: lineNumberError
+ * -------------------------
+ * Reports a jump to a line that does not exist.  This is not an
+ * error in the sense of error(): the program goes on running.
+ */
+
+void lineNumberError() {
+    OutputSink &out = standardOutput();
+    out.write("LINE NUMBER ERROR");
+    out.endLine();
+}
+
+/*
+ * Function: makeRecord
+ * --------------------
+ * Returns a record with the given operation and empty operands.
+ */
+
+static StatementRecord makeRecord(StatementOp opcode) {
+    return {opcode, 0, -1, -1, nullptr, nullptr, nullptr, nullptr, nullptr, 0, 0, -1, -1};
+}
+
+/*
+ * Implementation notes: runImage
+ * ------------------------------
+ * Under GCC and Clang the loop is threaded: the end of every handler
+ * jumps straight to the handler of the next record through a table of
+ * label addresses, so each handler has its own indirect branch and the
+ * predictor learns the sequences of a loop separately.  Elsewhere, or
+ * when BASIC_NO_COMPUTED_GOTO is defined, the same handlers become the
+ * cases of a switch.  Control flow is held entirely in rec, and every
+ * handler runs exactly the code of the execute method of the statement
+ * its record was lowered from.
+ *
+ * Only LET, PRINT and IF have a cold tier, since the others have no
+ * expression to compile.  Their handlers send a cold record to the
+ * code at tiered, which calls execute on the statement itself.  When a
+ * record is promoted the opcode is dispatched again, so the line runs
+ * in its hot handler, or as part of its compiled block, from that very
+ * execution on, without the program being restarted.  The record at
+ * which the code of a compiled block starts is sent to tiered as well,
+ * so the handlers of hot records still make a single test.
+ */
+
+/*
+ * Constant: TRACE_THRESHOLD
+ * -------------------------
+ * The number of times a backward jump is taken before the loop it
+ * closes is recorded as a trace.
+ */
+
+static const int TRACE_THRESHOLD = 16;
+
+/*
+ * Function: jumpBack
+ * ------------------
+ * Takes the jump of rec to an earlier record and returns the record
+ * to continue at.  Once the jump has been taken TRACE_THRESHOLD times
+ * the loop is recorded, and from then on its trace runs until one of
+ * its guards fails.  A loop that cannot be traced is not tried again.
+ */
+
+static StatementRecord *jumpBack(StatementRecord *image, StatementRecord *rec, Program &program, EvalState &state) {
+    TraceCache &traces = program.getTraces();
+    if (rec->trace >= 0) return image + traces.run(rec->trace, state);
+    if (rec->jumps == TRACE_THRESHOLD) return image + rec->target;
+    if (++rec->jumps < TRACE_THRESHOLD) return image + rec->target;
+    int next;
+    rec->trace = traces.record(image, rec->target, program, state, next);
+    return image + next;
+}
+
+/*
+ * Function: hasTier
+ * -----------------
+ * Returns true if the record has a cold tier, which only LET, PRINT
+ * and IF have.
+ */
+
+static bool hasTier(const StatementRecord &rec) {
+    return rec.opcode == STMT_LET || rec.opcode == STMT_PRINT || rec.opcode == STMT_IF;
+}
+
+/*
+ * Function: compileBlock
+ * ----------------------
+ * Called when rec is promoted or is already hot when the program is
+ * linked.  The code of a block starts at its first record with a cold
+ * tier, since only those records are sent to tiered; an INPUT before
+ * it runs in its own handler and falls through into the code.  If rec
+ * is that record, the rest of its block is compiled and rec marked so
+ * that its handler runs the block code instead of the statement.  A
+ * block that is a single GOTO or END has no such record, but its
+ * handler already runs the whole block in one piece.
+ */
+
+static void compileBlock(StatementRecord *image, StatementRecord *rec, Program &program) {
+    ControlFlowGraph &graph = program.getGraph();
+    int index = rec - image;
+    const BasicBlock &block = graph.getBlock(graph.findBlock(index));
+    for (int i = block.first; i < index; i++) {
+        if (hasTier(image[i])) return;
+    }
+    rec->block = program.getTraces().compileBlock(image, index, block.end);
+    if (rec->block >= 0) rec->countdown = -1;
+}
+
+void compileBlocks(StatementRecord *image, Program &program) {
+    ControlFlowGraph &graph = program.getGraph();
+    for (int i = 0; i < graph.getBlockCount(); i++) {
+        const BasicBlock &block = graph.getBlock(i);
+        int head = block.first;
+        while (head < block.end && !hasTier(image[head])) head++;
+        if (head < block.end && image[head].countdown == 0) {
+            compileBlock(image, image + head, program);
+        }
+    }
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(BASIC_NO_COMPUTED_GOTO)
+#define BASIC_THREADED_DISPATCH
+#endif
+
+#ifdef BASIC_THREADED_DISPATCH
+#define HANDLER(opcode) do_##opcode
+#define DISPATCH() goto *handlers[rec->opcode]
+#else
+#define HANDLER(opcode) case opcode
+#define DISPATCH() continue
+#endif
+
+void runImage(StatementRecord *image, Program &program, EvalState &state) {
+    StatementRecord *rec = image;
+    OutputSink &out = standardOutput();
+#ifdef BASIC_THREADED_DISPATCH
+    static void *const handlers[] = {
+        &&do_STMT_NOP, &&do_STMT_LET, &&do_STMT_PRINT, &&do_STMT_INPUT,
+        &&do_STMT_END, &&do_STMT_GOTO, &&do_STMT_IF, &&do_STMT_HALT
+    };
+    DISPATCH();
+    {
+#else
+    while (true) switch (rec->opcode) {
+#endif
+        HANDLER(STMT_NOP):
+            rec++;
+            DISPATCH();
+        HANDLER(STMT_LET):
+            if (rec->countdown != 0) goto tiered;
+            state.setValue(rec->slot, evaluateHot(rec->lhs, *rec->lhsCode, state));
+            rec++;
+            DISPATCH();
+        HANDLER(STMT_PRINT):
+            if (rec->countdown != 0) goto tiered;
+            out.writeInt(evaluateHot(rec->lhs, *rec->lhsCode, state));
+            out.endLine();
+            rec++;
+            DISPATCH();
+        HANDLER(STMT_INPUT):
+            readInput(rec->slot, state);
+            rec++;
+            DISPATCH();
+        HANDLER(STMT_GOTO):
+            if (rec->target > rec - image) {
+                rec = image + rec->target;
+            }
+            else if (rec->target >= 0) {
+                rec = jumpBack(image, rec, program, state);
+            }
+            else {
+                lineNumberError();
+                rec++;
+            }
+            DISPATCH();
+        HANDLER(STMT_IF): {
+            if (rec->countdown != 0) goto tiered;
+            int left_value = evaluateHot(rec->lhs, *rec->lhsCode, state);
+            int right_value = evaluateHot(rec->rhs, *rec->rhsCode, state);
+            if (!compare(left_value, rec->op, right_value)) {
+                rec++;
+            }
+            else if (rec->target > rec - image) {
+                rec = image + rec->target;
+            }
+            else if (rec->target >= 0) {
+                rec = jumpBack(image, rec, program, state);
+            }
+            else {
+                lineNumberError();
+                rec++;
+            }
+            DISPATCH();
+        }
+        HANDLER(STMT_END):
+        HANDLER(STMT_HALT):
+            return;
+        tiered:
+            if (rec->countdown < 0) {
+                rec = image + program.getTraces().run(rec->block, state);
+            }
+            else if (--rec->countdown == 0) {
+                rec->stmt->promote();
+                compileBlock(image, rec, program);
+            }
+            else {
+                int next = rec->stmt->execute(program, state);
+                if (next == EXEC_END) return;
+                if (next == EXEC_NEXT) {
+                    rec++;
+                }
+                else {
+                    rec = image + next;
+                }
+            }
+            DISPATCH();
+    }
+}
+
+#undef HANDLER
+#undef DISPATCH
+
 int stringToInt(std::string str) {
   try {
     return std::stoi(str);
@@ -26,9 +392,26 @@ int stringToInt(std::string str) {
 }
 Statement::Statement() = default;
 Statement::~Statement() = default;
-void Statement::execute(Program& program, EvalState& state) {}
+void *Statement::operator new(size_t size) {
+    return NodeArena::allocate(size);
+}
+void Statement::operator delete(void *ptr) {
+    NodeArena::deallocate(ptr);
+}
+int Statement::execute(Program& program, EvalState& state) {
+    return EXEC_NEXT;
+}
+void Statement::link(Program& program) {}
+void Statement::resolve(EvalState& state) {}
+void Statement::optimize() {}
+void Statement::lower(StatementRecord &rec) {
+    rec = makeRecord(STMT_NOP);
+}
+void Statement::promote() {}
 //REM
-void RemStatement::execute(Program &program, EvalState &state) {}
+int RemStatement::execute(Program &program, EvalState &state) {
+    return EXEC_NEXT;
+}
 RemStatement::RemStatement() {}
 RemStatement::~RemStatement() {}
 statement_type RemStatement::getType() {
@@ -36,13 +419,32 @@ statement_type RemStatement::getType() {
 }
 
 //LET
-void LetStatement::execute(Program &program, EvalState &state) {
-    int var_value = expr->eval(state);
-    state.setValue(varname, var_value);
+int LetStatement::execute(Program &program, EvalState &state) {
+    int var_value = evaluate(expr, code, state);
+    state.setValue(slot, var_value);
+    return EXEC_NEXT;
 }
 LetStatement::LetStatement(std::string varname, Expression* expr) {
     this->expr = expr;
     this->varname = varname;
+    this->slot = -1;
+}
+void LetStatement::resolve(EvalState &state) {
+    slot = state.getSlot(varname);
+    prepare(expr, state);
+}
+void LetStatement::optimize() {
+    simplify(expr);
+}
+void LetStatement::lower(StatementRecord &rec) {
+    rec = makeRecord(STMT_LET);
+    rec.lhs = expr;
+    rec.lhsCode = &code;
+    rec.slot = slot;
+    startCold(rec, expr, code);
+}
+void LetStatement::promote() {
+    compile(expr, code);
 }
 LetStatement::~LetStatement() {
     delete expr;
@@ -52,13 +454,31 @@ statement_type LetStatement::getType() {
 }
 
 //PRINT
-void PrintStatement::execute(Program &program, EvalState &state) {
-    int print_value = expr->eval(state);
-    std::cout << print_value << std::endl;
+int PrintStatement::execute(Program &program, EvalState &state) {
+    int print_value = evaluate(expr, code, state);
+    OutputSink &out = standardOutput();
+    out.writeInt(print_value);
+    out.endLine();
+    return EXEC_NEXT;
 }
 PrintStatement::PrintStatement(Expression* expr) {
     this->expr = expr;
 }
+void PrintStatement::resolve(EvalState &state) {
+    prepare(expr, state);
+}
+void PrintStatement::optimize() {
+    simplify(expr);
+}
+void PrintStatement::lower(StatementRecord &rec) {
+    rec = makeRecord(STMT_PRINT);
+    rec.lhs = expr;
+    rec.lhsCode = &code;
+    startCold(rec, expr, code);
+}
+void PrintStatement::promote() {
+    compile(expr, code);
+}
 PrintStatement::~PrintStatement() {
     delete expr;
 }
@@ -67,41 +487,20 @@ statement_type PrintStatement::getType() {
 }
 
 //INPUT
-void InputStatement::execute(Program &program, EvalState &state) {
-    std::string input;
-    while (true) {
-        std::cout<<" ?"<<" ";
-        bool check = true;
-        bool if_negative = false;
-        std::getline(std::cin, input);
-        TokenScanner input_scanner;
-        input_scanner.ignoreWhitespace();
-        input_scanner.scanNumbers();
-        input_scanner.scanStrings();
-        input_scanner.setInput(input);
-        std::string num = input_scanner.nextToken();
-        try {
-            if (input_scanner.hasMoreTokens() && input.front() != '-') {
-                error("INVALID NUMBER");
-            }
-            if (input.front() == '-') {
-                state.setValue(varname,std::stoi(input));
-                return;
-            }
-            for (int i = 0; i < num.size(); i++) {
-                if (num[i] != '-' && (!(isdigit(num[i])))) {
-                    error("INVALID NUMBER");
-                }
-            }
-            state.setValue(varname,std::stoi(num));
-            return;
-        } catch (ErrorException& ex) {
-            std::cout << ex.getMessage() << std::endl;
-        }
-    }
+int InputStatement::execute(Program &program, EvalState &state) {
+    readInput(slot, state);
+    return EXEC_NEXT;
 }
 InputStatement::InputStatement(std::string varname) {
     this->varname = varname;
+    this->slot = -1;
+}
+void InputStatement::resolve(EvalState &state) {
+    slot = state.getSlot(varname);
+}
+void InputStatement::lower(StatementRecord &rec) {
+    rec = makeRecord(STMT_INPUT);
+    rec.slot = slot;
 }
 InputStatement::~InputStatement() {}
 statement_type InputStatement::getType() {
@@ -109,27 +508,36 @@ statement_type InputStatement::getType() {
 }
 
 //END
-void EndStatement::execute(Program &program, EvalState &state) {
-    program.endprogram();
+int EndStatement::execute(Program &program, EvalState &state) {
+    return EXEC_END;
 }
 EndStatement::EndStatement() {}
+void EndStatement::lower(StatementRecord &rec) {
+    rec = makeRecord(STMT_END);
+}
 EndStatement::~EndStatement() {}
 statement_type EndStatement::getType() {
     return END;
 }
 
 //GOTO
-void GotoStatement::execute(Program &program, EvalState &state) {
-    if (program.check_line(number)) {
-        program.goto_line(number);
-        program.jump();
-    }
-    else {
-        std::cout << "LINE NUMBER ERROR" << std::endl;
+int GotoStatement::execute(Program &program, EvalState &state) {
+    if (target >= 0) {
+        return target;
     }
+    lineNumberError();
+    return EXEC_NEXT;
 }
 GotoStatement::GotoStatement(int x) {
     number = x;
+    target = -1;
+}
+void GotoStatement::link(Program &program) {
+    target = program.findImageIndex(number);
+}
+void GotoStatement::lower(StatementRecord &rec) {
+    rec = makeRecord(STMT_GOTO);
+    rec.target = target;
 }
 GotoStatement::~GotoStatement() {}
 statement_type GotoStatement::getType() {
@@ -137,80 +545,55 @@ statement_type GotoStatement::getType() {
 }
 
 //IF
-void IfStatement::execute(Program &program, EvalState &state) {
-    TokenScanner condition_scanner;
-    condition_scanner.ignoreWhitespace();
-    condition_scanner.scanNumbers();
-    condition_scanner.scanStrings();
-    condition_scanner.setInput(condition);
-    std::string left = "";
-    std::string s;
-    while (condition_scanner.hasMoreTokens()) {
-        s = condition_scanner.nextToken();
-        if (s == ">" || s == "<" || s=="=") {
-            break;
-        }
-        else {
-            left += s;
-            left += " ";
-        }
-    }
-    char op = s[0];
-    std::string right = "";
-    while (condition_scanner.hasMoreTokens()) {
-        s = condition_scanner.nextToken();
-        right += s;
-        right += " ";
-    }
-    TokenScanner left_scanner;
-    left_scanner.ignoreWhitespace();
-    left_scanner.scanNumbers();
-    left_scanner.scanStrings();
-    left_scanner.setInput(left);
-    Expression* left_expr = parseExp(left_scanner);
-    int left_value = left_expr->eval(state);
-    TokenScanner right_scanner;
-    right_scanner.ignoreWhitespace();
-    right_scanner.scanNumbers();
-    right_scanner.scanStrings();
-    right_scanner.setInput(right);
-    Expression* right_expr = parseExp(right_scanner);
-    int right_value = right_expr->eval(state);
-    bool ans = false;
-    switch(op) {
-        case '=':
-            ans = (left_value == right_value);
-            break;
-        case '<':
-            ans = (left_value < right_value);
-            break;
-        case '>':
-            ans = (left_value > right_value);
-            break;
-        default:
-            ans = false;
-            break;
-    }
+int IfStatement::execute(Program &program, EvalState &state) {
+    int left_value = evaluate(lhs, lhsCode, state);
+    int right_value = evaluate(rhs, rhsCode, state);
+    bool ans = compare(left_value, op, right_value);
     if (ans) {
-        if (program.check_line(linenumber)) {
-            program.goto_line(linenumber);
-            program.jump();
-        }
-        else {
-            std::cout << "LINE NUMBER ERROR" << std::endl;
+        if (target >= 0) {
+            return target;
         }
+        lineNumberError();
     }
-    else {
-        program.not_jump();
-    }
-    delete left_expr;
-    delete right_expr;
+    return EXEC_NEXT;
 }
-IfStatement::IfStatement(std::string condition, int linenumber) {
-    this->condition = condition; 
+IfStatement::IfStatement(Expression *lhs, char op, Expression *rhs, int linenumber) {
+    this->lhs = lhs;
+    this->op = op;
+    this->rhs = rhs;
     this->linenumber = linenumber;
+    this->target = -1;
+}
+void IfStatement::link(Program &program) {
+    target = program.findImageIndex(linenumber);
+}
+void IfStatement::resolve(EvalState &state) {
+    prepare(lhs, state);
+    prepare(rhs, state);
+}
+void IfStatement::optimize() {
+    simplify(lhs);
+    simplify(rhs);
+}
+void IfStatement::lower(StatementRecord &rec) {
+    rec = makeRecord(STMT_IF);
+    rec.lhs = lhs;
+    rec.rhs = rhs;
+    rec.lhsCode = &lhsCode;
+    rec.rhsCode = &rhsCode;
+    rec.op = op;
+    rec.target = target;
+    startCold(rec, lhs, lhsCode);
+    startCold(rec, rhs, rhsCode);
+}
+void IfStatement::promote() {
+    compile(lhs, lhsCode);
+    compile(rhs, rhsCode);
+}
+IfStatement::~IfStatement() {
+    delete lhs;
+    delete rhs;
 }
-IfStatement::~IfStatement() {}
 statement_type IfStatement::getType() {
     return IF;
 }
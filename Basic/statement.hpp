@@ -14,12 +14,117 @@
 
 #include "evalstate.hpp"
 #include "exp.hpp"
+#include "bytecode.hpp"
 
 enum statement_type {
     REM, LET, PRINT, INPUT, END, GOTO, IF
 };
 
 class Program;
+class Statement;
+
+/*
+ * Constants: EXEC_NEXT, EXEC_END
+ * ------------------------------
+ * Control results returned by Statement::execute in place of an image
+ * index: continue with the following statement, or stop the program.
+ */
+
+const int EXEC_NEXT = -1;
+const int EXEC_END = -2;
+
+/*
+ * Type: StatementOp
+ * -----------------
+ * The operation of a record in the program image.  STMT_HALT only
+ * appears in the sentinel record that Program::link places after the
+ * last statement, so running off the end of the program needs no
+ * bounds check.
+ */
+
+enum StatementOp {
+    STMT_NOP, STMT_LET, STMT_PRINT, STMT_INPUT, STMT_END, STMT_GOTO, STMT_IF, STMT_HALT
+};
+
+/*
+ * Type: StatementRecord
+ * ---------------------
+ * The form in which a statement is stored in the program image built
+ * by Program::link.  Records are plain fixed-size values laid out in
+ * execution order, with every operand already in the record instead
+ * of behind a pointer to a polymorphic object.  The expressions and
+ * their compiled code still belong to the statement the record was
+ * lowered from.
+ *
+ * A record whose expressions have not been compiled yet starts in the
+ * cold tier, where runImage hands it to the execute method of stmt
+ * and counts down how often the line has run.  When countdown reaches
+ * zero the line is promoted: its statement compiles the expressions
+ * and from then on the record runs in the handlers of runImage.
+ *
+ * A GOTO or IF whose jump back to an earlier record has been taken
+ * often enough has the loop it closes recorded as a trace, which then
+ * runs in place of the jump (see trace.h).  When the first line of a
+ * basic block that has a cold tier is promoted, or is already hot when
+ * the program is linked, the block is compiled from that line on, and
+ * from then on runs in one piece whenever control reaches the line
+ * (see cfg.h).
+ */
+
+struct StatementRecord {
+    StatementOp opcode;
+    char op;              /* Comparison of IF                     */
+    int slot;             /* Variable of LET and INPUT            */
+    int target;           /* GOTO and IF image index, -1 if none  */
+    Expression *lhs;      /* LET and PRINT expression, left of IF */
+    Expression *rhs;      /* Right side of IF                     */
+    ExpCode *lhsCode;
+    ExpCode *rhsCode;
+    Statement *stmt;      /* Statement the record was lowered from */
+    int countdown;        /* Runs left before promotion, 0 if hot, */
+                          /* -1 if the code of a block starts here */
+    int jumps;            /* Backward jumps taken, while counting  */
+    int trace;            /* Trace run in place of the backward    */
+                          /* jump of GOTO and IF, -1 if none       */
+    int block;            /* Block code starting here, -1 if none  */
+};
+
+/*
+ * Function: runImage
+ * Usage: runImage(image, program, state);
+ * ---------------------------------------
+ * Executes a linked program image from its first record until an END
+ * statement or the sentinel record is reached.  The records of cold
+ * lines are updated as they run and promoted once they are hot.
+ */
+
+void runImage(StatementRecord *image, Program &program, EvalState &state);
+
+/*
+ * Function: compileBlocks
+ * Usage: compileBlocks(image, program);
+ * -------------------------------------
+ * Compiles every basic block of a newly linked image whose lines are
+ * already hot, having been promoted during an earlier RUN, so that the
+ * block runs in one piece from the start.
+ */
+
+void compileBlocks(StatementRecord *image, Program &program);
+
+/*
+ * Functions: readInput, lineNumberError
+ * Usage: readInput(slot, state);
+ *        lineNumberError();
+ * -------------------------------------
+ * The parts of INPUT and of a jump to a missing line that talk to the
+ * user.  readInput prompts until a valid number is entered and stores
+ * it in the slot; lineNumberError reports the missing line, after
+ * which the program goes on running.  Neither raises an error.
+ */
+
+void readInput(int slot, EvalState &state);
+
+void lineNumberError();
 
 /*
  * Class: Statement
@@ -55,18 +160,87 @@ public:
 
     virtual ~Statement();
 
+/*
+ * Operators: new, delete
+ * ----------------------
+ * Like expression nodes, statements are allocated from the current
+ * NodeArena if there is one and from the heap otherwise.
+ */
+
+    static void *operator new(size_t size);
+
+    static void operator delete(void *ptr);
+
 /*
  * Method: execute
- * Usage: stmt->execute(state);
- * ----------------------------
+ * Usage: int next = stmt->execute(state);
+ * ---------------------------------------
  * This method executes a BASIC statement.  Each of the subclasses
  * defines its own execute method that implements the necessary
  * operations.  As was true for the expression evaluator, this
  * method takes an EvalState object for looking up variables or
- * controlling the operation of the interpreter.
+ * controlling the operation of the interpreter.  The result is the
+ * image index to continue at, EXEC_NEXT or EXEC_END.
+ */
+
+    virtual int execute(Program &program, EvalState &state);
+
+/*
+ * Method: link
+ * Usage: stmt->link(program);
+ * ---------------------------
+ * Called by Program::link once the program image has been built.
+ * Statements that transfer control resolve their target line to an
+ * image index here; the default implementation does nothing.
+ */
+
+    virtual void link(Program &program);
+
+/*
+ * Method: resolve
+ * Usage: stmt->resolve(state);
+ * ----------------------------
+ * Called once after the statement is parsed and before it is first
+ * executed, and after optimize if the statement is installed in the
+ * program.  Statements assign slots to the variables they use here
+ * and prepare their expressions for evaluation; the default
+ * implementation does nothing.
  */
 
-    virtual void execute(Program &program, EvalState &state);
+    virtual void resolve(EvalState &state);
+
+/*
+ * Method: optimize
+ * Usage: stmt->optimize();
+ * ------------------------
+ * Called by Program::setParsedStatement when the statement is
+ * installed in the program, before resolve.  Statements simplify
+ * their expressions here; the default implementation does nothing.
+ */
+
+    virtual void optimize();
+
+/*
+ * Method: lower
+ * Usage: stmt->lower(rec);
+ * ------------------------
+ * Fills in the image record that Program::link stores for this
+ * statement.  It is called after link, so jump targets are known.
+ * The default implementation produces a record that does nothing.
+ */
+
+    virtual void lower(StatementRecord &rec);
+
+/*
+ * Method: promote
+ * Usage: stmt->promote();
+ * -----------------------
+ * Called by runImage once the line of the statement has run often
+ * enough to be worth compiling.  Statements compile their expressions
+ * into bytecode here; the default implementation does nothing.
+ */
+
+    virtual void promote();
 
     virtual statement_type getType() = 0;
 
@@ -89,7 +263,7 @@ public:
 
     RemStatement();
 
-    void execute(Program &program, EvalState &state) override;
+    int execute(Program &program, EvalState &state) override;
 
     statement_type getType() override;
 
@@ -106,7 +280,15 @@ class LetStatement:public Statement {
 public:
     LetStatement(std::string varname, Expression* expr);
 
-    void execute(Program &program, EvalState &state) override;
+    int execute(Program &program, EvalState &state) override;
+
+    void resolve(EvalState &state) override;
+
+    void optimize() override;
+
+    void lower(StatementRecord &rec) override;
+
+    void promote() override;
 
     statement_type getType() override;
 
@@ -116,8 +298,12 @@ private:
 
     std::string varname;
 
+    int slot;
+
     Expression* expr;
 
+    ExpCode code;
+
 };
 
 class PrintStatement:public Statement {
@@ -126,7 +312,15 @@ public:
 
     PrintStatement(Expression* expr);
 
-    void execute(Program &program, EvalState &state) override;
+    int execute(Program &program, EvalState &state) override;
+
+    void resolve(EvalState &state) override;
+
+    void optimize() override;
+
+    void lower(StatementRecord &rec) override;
+
+    void promote() override;
 
     statement_type getType() override;
 
@@ -136,6 +330,8 @@ private:
 
     Expression* expr;
 
+    ExpCode code;
+
 };
 
 class InputStatement:public Statement {
@@ -144,7 +340,11 @@ public:
 
     InputStatement(std::string var_name);
 
-    void execute(Program &program, EvalState &state) override;
+    int execute(Program &program, EvalState &state) override;
+
+    void resolve(EvalState &state) override;
+
+    void lower(StatementRecord &rec) override;
 
     statement_type getType() override;
 
@@ -154,6 +354,8 @@ private:
 
     std::string varname;
 
+    int slot;
+
 };
 
 class EndStatement:public Statement {
@@ -162,7 +364,9 @@ public:
 
     EndStatement();
 
-    void execute(Program &program, EvalState &state) override;
+    int execute(Program &program, EvalState &state) override;
+
+    void lower(StatementRecord &rec) override;
 
     statement_type getType() override;
 
@@ -176,7 +380,11 @@ public:
 
     GotoStatement(int x);
 
-    void execute(Program &program, EvalState &state) override;
+    int execute(Program &program, EvalState &state) override;
+
+    void link(Program &program) override;
+
+    void lower(StatementRecord &rec) override;
 
     statement_type getType() override;
 
@@ -186,15 +394,27 @@ private:
 
     int number;
 
+    int target;
+
 };
 
 class IfStatement:public Statement {
 
 public:
 
-    IfStatement(std::string condition, int then_number);
+    IfStatement(Expression *lhs, char op, Expression *rhs, int then_number);
+
+    int execute(Program &program, EvalState &state) override;
+
+    void link(Program &program) override;
+
+    void resolve(EvalState &state) override;
 
-    void execute(Program &program, EvalState &state) override;
+    void optimize() override;
+
+    void lower(StatementRecord &rec) override;
+
+    void promote() override;
 
     statement_type getType() override;
 
@@ -204,7 +424,23 @@ private:
 
     int linenumber;
 
-    std::string condition;
+    int target;
+
+/*
+ * The condition is parsed once when the line is entered and kept as
+ * a comparison node: two expression trees joined by one of the
+ * relational operators '<', '=' or '>'.
+ */
+
+    Expression *lhs;
+
+    char op;
+
+    Expression *rhs;
+
+    ExpCode lhsCode;
+
+    ExpCode rhsCode;
 
 };
 
@@ -0,0 +1,282 @@
+/*
+ * File: trace.cpp
+ * ---------------
+ * This file implements the TraceCache class.
+ */
+
+#include <algorithm>
+#include "trace.hpp"
+
+/*
+ * Constant: MAX_CODE_SIZE
+ * -----------------------
+ * The most instructions reset reserves for the traces of one image,
+ * however large the program.  Once they are used up no more loops are
+ * traced.
+ */
+
+static const size_t MAX_CODE_SIZE = 1 << 16;
+
+TraceCache::TraceCache() = default;
+
+/*
+ * Function: traceCost
+ * -------------------
+ * Returns the most instructions a record can add to a trace: a check
+ * of three instructions and a copy for every node, and one instruction
+ * to store, print or test the result.
+ */
+
+static size_t traceCost(const StatementRecord &rec) {
+    return 4 * (countNodes(rec.lhs) + countNodes(rec.rhs)) + 1;
+}
+
+/*
+ * Function: hasCode
+ * -----------------
+ * Returns true if the expressions of the record have been compiled,
+ * promoting its statement first if they have not.  The room for the
+ * code was reserved when the program was linked, so this allocates
+ * nothing.  In builds without bytecode nothing is ever compiled, and
+ * so nothing is traced.
+ */
+
+static bool hasCode(const StatementRecord &rec) {
+    if (rec.lhsCode->isEmpty()) rec.stmt->promote();
+    return !rec.lhsCode->isEmpty();
+}
+
+/*
+ * Function: canTrace
+ * ------------------
+ * Returns true if the record can be part of a trace.  INPUT and END
+ * end a trace, and so does a jump to a missing line, since none of
+ * them can be repeated without the interpreter.
+ */
+
+static bool canTrace(const StatementRecord &rec) {
+    switch (rec.opcode) {
+        case STMT_NOP:
+            return true;
+        case STMT_LET:
+            return rec.slot >= 0 && hasCode(rec);
+        case STMT_PRINT:
+            return hasCode(rec);
+        case STMT_GOTO:
+            return rec.target >= 0;
+        case STMT_IF:
+            if (rec.target < 0) return false;
+            if (rec.op != '=' && rec.op != '<' && rec.op != '>') return false;
+            return hasCode(rec);
+        default:
+            return false;
+    }
+}
+
+/*
+ * Function: exitWhen
+ * ------------------
+ * Returns the instruction that leaves the code when the comparison of
+ * an IF holds, or when it does not if holds is false.
+ */
+
+static OpCode exitWhen(char op, bool holds) {
+    switch (op) {
+        case '=': return holds ? OP_EXIT_EQ : OP_EXIT_NE;
+        case '<': return holds ? OP_EXIT_LT : OP_EXIT_GE;
+        default: return holds ? OP_EXIT_GT : OP_EXIT_LE;
+    }
+}
+
+/*
+ * Implementation notes: reset
+ * ---------------------------
+ * No trace holds a record twice, so twice the cost of the whole image
+ * leaves room for every loop of a program to be traced at least once
+ * even if their paths overlap.  The operand stack never grows deeper
+ * than a record has nodes, or than the two values of an entry check.
+ */
+
+void TraceCache::reset(const StatementRecord *image, int size) {
+    code.clear();
+    size_t capacity = 0;
+    int depth = 2;
+    for (int i = 0; i < size; i++) {
+        capacity += 2 * (traceCost(image[i]) + 1);
+        depth = std::max(depth, countNodes(image[i].lhs) + countNodes(image[i].rhs));
+    }
+    code.reserve(std::min(capacity, MAX_CODE_SIZE));
+    stack.assign(depth, 0);
+}
+
+/*
+ * Implementation notes: record
+ * ----------------------------
+ * A record that is already on the path means that the loop contains
+ * another loop, whose own backward jump will be traced instead.
+ */
+
+int TraceCache::record(StatementRecord *image, int header, Program &program, EvalState &state, int &next) {
+    int length = 0;
+    int index = header;
+    while (length == 0 || index != header) {
+        StatementRecord &rec = image[index];
+        bool seen = std::find(path, path + length, index) != path + length;
+        if (seen || length == MAX_TRACE_LENGTH || !canTrace(rec)) {
+            next = index;
+            return -1;
+        }
+        path[length++] = index;
+        int result = rec.stmt->execute(program, state);
+        index = (result == EXEC_NEXT) ? index + 1 : result;
+    }
+    next = header;
+    int start = code.size();
+    if (!compile(image, length, header)) return -1;
+    return start;
+}
+
+/*
+ * Implementation notes: compile
+ * -----------------------------
+ * The guard for an IF is the opposite of the comparison when the
+ * branch was taken on the recorded path and the comparison itself
+ * when it was not.  If the record after the IF is also its target
+ * the guard may leave the trace needlessly, but never wrongly.
+ */
+
+bool TraceCache::compile(const StatementRecord *image, int length, int header) {
+    size_t cost = 1;
+    for (int i = 0; i < length; i++) {
+        cost += traceCost(image[path[i]]);
+    }
+    if (code.size() + cost > code.capacity()) return false;
+    int start = code.size();
+    for (int i = 0; i < length; i++) {
+        const StatementRecord &rec = image[path[i]];
+        if (rec.lhsCode != nullptr) emitChecks(rec.lhsCode, start, header);
+        if (rec.rhsCode != nullptr) emitChecks(rec.rhsCode, start, header);
+    }
+    int body = code.size();
+    for (int i = 0; i < length; i++) {
+        const StatementRecord &rec = image[path[i]];
+        switch (rec.opcode) {
+            case STMT_LET:
+                emitCode(rec.lhsCode, OP_FETCH);
+                emit(OP_SET, rec.slot);
+                break;
+            case STMT_PRINT:
+                emitCode(rec.lhsCode, OP_FETCH);
+                emit(OP_PRINT, 0);
+                break;
+            case STMT_IF: {
+                int following = (i + 1 < length) ? path[i + 1] : header;
+                bool taken = (following == rec.target);
+                emitCode(rec.lhsCode, OP_FETCH);
+                emitCode(rec.rhsCode, OP_FETCH);
+                emit(exitWhen(rec.op, !taken), taken ? path[i] + 1 : rec.target);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    emit(OP_LOOP, code.size() - body);
+    return true;
+}
+
+/*
+ * Implementation notes: compileBlock
+ * ----------------------------------
+ * Only the last record of a block can jump, so the code is a run of
+ * statements followed by one exit: the guard and fall-through jump of
+ * an IF, the jump of a GOTO, or a jump to the first record that was
+ * not compiled.
+ */
+
+int TraceCache::compileBlock(const StatementRecord *image, int first, int end) {
+    size_t cost = 2;
+    for (int i = first; i < end; i++) {
+        cost += traceCost(image[i]);
+    }
+    if (code.size() + cost > code.capacity()) return -1;
+    int start = code.size();
+    int index = first;
+    for (; index < end; index++) {
+        const StatementRecord &rec = image[index];
+        bool forward = rec.target > index;
+        if (!canTrace(rec) || ((rec.opcode == STMT_GOTO || rec.opcode == STMT_IF) && !forward)) break;
+        if (rec.opcode == STMT_LET) {
+            emitCode(rec.lhsCode, OP_LOAD);
+            emit(OP_SET, rec.slot);
+        } else if (rec.opcode == STMT_PRINT) {
+            emitCode(rec.lhsCode, OP_LOAD);
+            emit(OP_PRINT, 0);
+        } else if (rec.opcode == STMT_GOTO) {
+            emit(OP_JUMP, rec.target);
+            return start;
+        } else if (rec.opcode == STMT_IF) {
+            emitCode(rec.lhsCode, OP_LOAD);
+            emitCode(rec.rhsCode, OP_LOAD);
+            emit(exitWhen(rec.op, true), rec.target);
+            emit(OP_JUMP, index + 1);
+            return start;
+        }
+    }
+    if (index == first) return -1;
+    emit(OP_JUMP, index);
+    return start;
+}
+
+void TraceCache::emit(OpCode op, int operand) {
+    code.push_back({op, operand});
+}
+
+/*
+ * Implementation notes: emitChecks
+ * --------------------------------
+ * A variable that is only assigned by the expression is not read, so
+ * it needs no check.  Every other variable is checked once per trace,
+ * by testing whether it is defined and leaving for header if not.
+ */
+
+void TraceCache::emitChecks(ExpCode *exp, int start, int header) {
+    for (const Instruction *ip = exp->getInstructions(); ip->op != OP_RETURN; ip++) {
+        if (ip->op != OP_LOAD) continue;
+        bool checked = false;
+        for (size_t i = start; i < code.size(); i++) {
+            if (code[i].op == OP_DEFINED && code[i].operand == ip->operand) checked = true;
+        }
+        if (checked) continue;
+        emit(OP_DEFINED, ip->operand);
+        emit(OP_CONST, 0);
+        emit(OP_EXIT_EQ, header);
+    }
+}
+
+/*
+ * Implementation notes: emitCode
+ * ------------------------------
+ * Copies the compiled expression without its OP_RETURN, so the value
+ * is left on the stack for the instruction that follows.  Every check
+ * and error of the expression is kept as it is, except that loads can
+ * be replaced by ones that skip the check.
+ */
+
+void TraceCache::emitCode(ExpCode *exp, OpCode load) {
+    for (const Instruction *ip = exp->getInstructions(); ip->op != OP_RETURN; ip++) {
+        emit(ip->op == OP_LOAD ? load : ip->op, ip->operand);
+    }
+}
+
+/*
+ * Implementation notes: run
+ * -------------------------
+ * The stack is empty between statements, so leaving the trace needs
+ * no cleanup.  OP_LOOP goes back to the first instruction after the
+ * checks, since a defined variable stays defined.
+ */
+
+int TraceCache::run(int trace, EvalState &state) {
+    return runCode(code.data() + trace, stack.data(), state);
+}
@@ -0,0 +1,129 @@
+/*
+ * File: trace.h
+ * -------------
+ * This interface exports the TraceCache class, which records the path
+ * the program takes around a hot loop and compiles it into a guarded
+ * straight-line trace.
+ */
+
+#ifndef _trace_h
+#define _trace_h
+
+#include <vector>
+#include "statement.hpp"
+#include "bytecode.hpp"
+#include "evalstate.hpp"
+
+class Program;
+
+/*
+ * Class: TraceCache
+ * -----------------
+ * The traces of one linked program image.  BASIC has no loop
+ * statement, so a loop is any backward GOTO or IF jump.  Once runImage
+ * has seen such a jump taken often enough, record runs one iteration
+ * of the loop from its first record, noting every statement it passes
+ * and which way each IF went, until control comes back to where it
+ * started.  The path is then compiled into a single instruction array
+ * with no jumps inside it except the one back to its start.  The code
+ * is made of the compiled expressions of the statements on the path,
+ * copied as they are, and runs on the machine of ExpCode.
+ *
+ * Every IF on the path becomes a guard that leaves the trace, at the
+ * record the interpreter would have continued with, when the branch
+ * goes the other way.  The variables the trace reads are checked once
+ * on entry, which lets the loads inside the loop skip the check; if
+ * one is not defined yet, the trace is left before it does anything.
+ *
+ * The same code also runs the basic blocks of the control-flow graph
+ * that have become hot, with every variable checked where it is read
+ * and the jump at the end of the block leaving the code.
+ *
+ * All the memory the traces need is allocated by reset, so recording
+ * and running a trace during RUN allocates nothing.
+ */
+
+class TraceCache {
+
+public:
+
+/*
+ * Constructor: TraceCache
+ * Usage: TraceCache traces;
+ * -------------------------
+ * Creates a cache holding no traces.
+ */
+
+    TraceCache();
+
+/*
+ * Method: reset
+ * Usage: traces.reset(image, size);
+ * ---------------------------------
+ * Discards every trace and makes room for the traces of the size
+ * records of image, which must end with the STMT_HALT sentinel.
+ */
+
+    void reset(const StatementRecord *image, int size);
+
+/*
+ * Method: record
+ * Usage: int trace = traces.record(image, header, program, state, next);
+ * ----------------------------------------------------------------------
+ * Runs the statements of image from index header, the target of a
+ * backward jump, one at a time through their execute methods, and
+ * records the path until control is back at header.  Returns the
+ * trace compiled from the path, or -1 if the loop left the path that
+ * can be traced, in which case next is the index of the first record
+ * that has not been run.  When a trace is returned next is header.
+ */
+
+    int record(StatementRecord *image, int header, Program &program, EvalState &state, int &next);
+
+/*
+ * Method: compileBlock
+ * Usage: int block = traces.compileBlock(image, first, end);
+ * ----------------------------------------------------------
+ * Compiles the records of image from first up to end, the rest of a
+ * basic block, into code that runs in place of them.  The code stops
+ * short of any record it cannot express, such as INPUT, and of a jump
+ * back to an earlier record, which stays with the interpreter so that
+ * its loop can be traced.  Returns -1 if not even the first record
+ * could be compiled.
+ */
+
+    int compileBlock(const StatementRecord *image, int first, int end);
+
+/*
+ * Method: run
+ * Usage: int next = traces.run(trace, state);
+ * -------------------------------------------
+ * Runs a trace returned by record until one of its guards fails, or
+ * a block returned by compileBlock to its end, and returns the image
+ * index at which the interpreter has to continue.  Errors are raised
+ * exactly where the interpreter would raise them.
+ */
+
+    int run(int trace, EvalState &state);
+
+private:
+
+    static const int MAX_TRACE_LENGTH = 256;
+
+    std::vector<Instruction> code;        /* Every trace, back to back   */
+
+    std::vector<int> stack;               /* Sized to the deepest push   */
+
+    int path[MAX_TRACE_LENGTH];
+
+    bool compile(const StatementRecord *image, int length, int header);
+
+    void emit(OpCode op, int operand);
+
+    void emitChecks(ExpCode *exp, int start, int header);
+
+    void emitCode(ExpCode *exp, OpCode load);
+
+};
+
+#endif
@@ -0,0 +1,18 @@
+10 REM blocks that start at GOTO, INPUT and END records
+20 LET k = 0
+30 GOTO 50
+40 END
+50 LET k = k + 1
+60 LET m = k * k
+70 IF k < 40 THEN 100
+80 INPUT x
+90 PRINT x + m
+95 GOTO 140
+100 PRINT m
+110 GOTO 130
+120 END
+130 GOTO 50
+140 IF x > 0 THEN 40
+150 PRINT k
+160 END
+RUN
@@ -0,0 +1,10 @@
+10 REM COMPILE is a command, not a reserved word, so it can name a variable
+20 LET COMPILE = 3
+30 INPUT n
+40 LET COMPILE = COMPILE + n
+50 IF COMPILE < 200 THEN 40
+60 PRINT COMPILE
+70 LET RUNS = COMPILE - 1
+80 PRINT RUNS
+90 END
+RUN
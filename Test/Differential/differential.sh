@@ -0,0 +1,109 @@
+#!/bin/bash
+#
+# File: differential.sh
+# ---------------------
+# Runs every program of this directory through each way the interpreter
+# can execute it and checks that all of them print the same thing:
+#
+#   script    -- code -j 1 program.bas, which is the reference
+#   expected  -- the reference against program.out, the output the
+#                program is known to print
+#   parallel  -- code -j 4 program.bas
+#   repl      -- the program and its input typed on standard input
+#   jit       -- the script and the REPL run with --jit
+#   compile   -- code --compile, then the executable it builds
+#   cfg       -- code --dump-cfg, whose standard output must not change
+#                and whose graph must match program.cfg
+#
+# A program ends with a single RUN; program.in, if there is one, is the
+# input its INPUT statements read.  Further programs can be named on the
+# command line, in which case they are only compared with each other.
+#
+# Usage: Test/Differential/differential.sh path/to/code [program.bas ...]
+#
+
+if [ $# -lt 1 ] || [ ! -x "$1" ]; then
+    echo "usage: $0 path/to/code [program.bas ...]" >&2
+    exit 2
+fi
+
+code=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+shift
+if [ $# -eq 0 ]; then
+    set -- "$(dirname "$0")"/*.bas
+fi
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+passed=0
+failed=0
+
+#
+# Function: check
+# Usage: check name file
+# ----------------------
+# Compares the output in file with the reference and reports the
+# program and the mode that differ.
+#
+
+check() {
+    if ! cmp -s "$work/script" "$2"; then
+        echo "FAIL $program: $1"
+        diff "$work/script" "$2" | head -5
+        ok=0
+    fi
+}
+
+for program in "$@"; do
+    base=${program%.bas}
+    input=/dev/null
+    [ -f "$base.in" ] && input=$base.in
+    ok=1
+
+    timeout 10 "$code" -j 1 "$program" < "$input" > "$work/script" 2> /dev/null
+
+    if [ -f "$base.out" ]; then
+        check expected "$base.out"
+    fi
+
+    timeout 10 "$code" -j 4 "$program" < "$input" > "$work/out" 2> /dev/null
+    check parallel "$work/out"
+
+    { cat "$program" "$input"; echo QUIT; } > "$work/typed"
+    timeout 10 "$code" < "$work/typed" > "$work/out" 2> /dev/null
+    check repl "$work/out"
+
+    timeout 10 "$code" --jit "$program" < "$input" > "$work/out" 2> /dev/null
+    check jit "$work/out"
+
+    timeout 10 "$code" --jit < "$work/typed" > "$work/out" 2> /dev/null
+    check "jit repl" "$work/out"
+
+    rm -f "$work/exe"
+    if timeout 60 "$code" --compile "$work/exe" "$program" > "$work/out" 2> "$work/cc"; then
+        timeout 10 "$work/exe" < "$input" >> "$work/out" 2> /dev/null
+        check compile "$work/out"
+    else
+        echo "FAIL $program: compile"
+        head -5 "$work/cc"
+        ok=0
+    fi
+
+    timeout 10 "$code" --dump-cfg "$program" < "$input" > "$work/out" 2> "$work/cfg"
+    check cfg "$work/out"
+    if [ -f "$base.cfg" ] && ! cmp -s "$base.cfg" "$work/cfg"; then
+        echo "FAIL $program: cfg dump"
+        diff "$base.cfg" "$work/cfg" | head -5
+        ok=0
+    fi
+
+    if [ $ok -eq 1 ]; then
+        passed=$((passed + 1))
+    else
+        failed=$((failed + 1))
+    fi
+done
+
+echo "passed: $passed, failed: $failed"
+[ $failed -eq 0 ]
@@ -0,0 +1,11 @@
+10 LET a = 7
+20 PRINT a / 2
+30 PRINT -a / 2
+40 LET q = 2147483647
+50 PRINT q + 1
+60 PRINT (a = 3) * (b = a + 1)
+70 PRINT a + b
+80 LET b = b - 4
+90 PRINT a / b
+100 PRINT 100
+RUN
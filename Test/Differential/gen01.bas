@@ -0,0 +1,13 @@
+70 LET a = 6 + y + 1 + y + (7) * 11 + 10 - (y = c + x * (9))
+5 LET k = 0
+110 LET x = x
+30 LET c = x
+80 INPUT c
+100 PRINT -5
+10 GOTO 90
+20 LET x = b
+40 LET c = (12 - 11 - c) - (x / y + 3)
+50 IF 4 / 1 / 12 + 10 > (y) THEN 50
+90 PRINT 10 * 5 + 0 - 7 - 8 - (9) * 0
+60 LET y = ((x = 0)) + 7 / a + (b = 1) + x
+RUN
@@ -0,0 +1,15 @@
+90 GOTO 120
+50 IF b - 10 / (b) > (y) - 5 * a THEN 70
+5 LET k = 0
+20 PRINT -4
+40 PRINT (2) / x - a * c * 3 - 2 * (y / y) - 8 + 6 - b
+105 IF k < 15 THEN 20
+10 LET c = -7
+70 GOTO 80
+30 PRINT 6
+110 IF x / c * 10 = 10 / a / b - a THEN 120
+80 PRINT 11
+100 LET k = k + 1
+120 IF b > x - a + (x) THEN 120
+60 PRINT -11 - -b - -1 - x * 12 + y / 8 * a - 8 + 5
+RUN
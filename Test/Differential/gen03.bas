@@ -0,0 +1,7 @@
+40 INPUT b
+10 PRINT (y = -7)
+50 LET y = a * 7
+30 PRINT 4
+5 LET k = 0
+20 PRINT (a = 0) - 8
+RUN
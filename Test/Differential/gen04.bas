@@ -0,0 +1,8 @@
+40 LET y = 9
+10 PRINT 8
+30 PRINT 3 + a * -8 - -c - b - c
+60 LET a = (a - 11) - 11
+20 PRINT -(8)
+50 LET c = x + 9
+5 LET k = 0
+RUN
@@ -0,0 +1,21 @@
+90 LET k = k + 1
+170 PRINT (x) - 5 / 11 * y + 6 / (-4)
+150 LET y = (a - 7 - 6 * -3)
+140 PRINT 10
+50 PRINT (c = y)
+25 IF k < 20 THEN 10
+95 IF k < 9 THEN 60
+110 PRINT (b = -5)
+5 LET k = 0
+130 PRINT -1
+70 LET x = (x = (x = 0))
+10 PRINT (9) - -7 / 4 / 4 / 9 + (a = 0)
+60 GOTO 100
+30 IF 3 = 1 / a THEN 110
+80 LET c = x + 11
+40 LET a = 9
+160 LET a = -(a = -4)
+100 GOTO 160
+20 LET k = k + 1
+120 IF -3 + 2 = c THEN 170
+RUN
@@ -0,0 +1,13 @@
+40 REM hello
+5 LET k = 0
+20 INPUT x
+30 PRINT 8
+10 PRINT 1 / -(0 + 11)
+100 INPUT c
+50 LET k = k + 1
+60 LET c = (a - b) / (2) - (3) - 4 - x - y
+70 PRINT (a = -1)
+55 IF k < 20 THEN 30
+90 LET y = x
+80 PRINT 1 * (a = y)
+RUN
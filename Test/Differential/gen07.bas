@@ -0,0 +1,8 @@
+30 LET k = k + 1
+50 PRINT (x = (x = 12)) * (4 - 1 + x + 2)
+20 PRINT 8
+10 PRINT 1
+5 LET k = 0
+40 LET a = -6 + (b - 12 / y)
+35 IF k < 25 THEN 10
+RUN
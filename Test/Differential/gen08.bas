@@ -0,0 +1,16 @@
+20 GOTO 999
+5 LET k = 0
+10 PRINT -7
+110 LET a = 5 / (b = c)
+140 LET x = --3
+50 LET x = (a = b)
+130 IF a = y * 5 * a THEN 130
+80 LET y = 2 - (b = x / a) + (7)
+40 LET a = 6 + (b = 8)
+100 LET b = (4 / c + (y) - 6 + 0 / (y = x))
+90 LET y = (y = -6 + 7) * a + (y) * b - a
+70 LET c = 10 - c
+30 PRINT 1 + b * a * -9 + -6
+60 GOTO 100
+120 LET c = x
+RUN
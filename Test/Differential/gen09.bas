@@ -0,0 +1,19 @@
+140 LET a = -1 / y
+40 LET a = (c = 0) * -9 - 7 / a + 7
+30 IF c - 0 + (y) > x - 8 THEN 80
+120 LET a = c
+80 REM hello
+115 IF k < 11 THEN 90
+20 PRINT 3 - 9
+150 PRINT 8 * 9 - x * x + (c = b - 9) * --y
+90 PRINT y + -7 * b - x / b
+50 IF 11 > (-0) THEN 50
+100 LET x = -(-12 - a)
+5 LET k = 0
+70 IF (6) - c < 9 * x - y * 1 THEN 999
+10 PRINT ((-4) - -7)
+160 END
+110 LET k = k + 1
+130 PRINT 6 - b - 6
+60 PRINT a + 6 * 1 - 9 + -x
+RUN
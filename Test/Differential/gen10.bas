@@ -0,0 +1,13 @@
+380 IF i < n THEN 19
+50 PRINT 12 * a - 0 - 6 + n * 15
+80 IF ( a / c * 16 * 15 - n / i / 11 ) < 12 + - n / 7 / n THEN 370
+320 LET i = i + 1
+16 LET a = 1
+170 LET c = ( 16 + n * i * i + n + 7 * b )
+17 LET b = 2
+19 LET i = i + 1
+370 REM hello
+15 LET n = 25
+10 LET i = 0
+18 LET c = 3
+RUN
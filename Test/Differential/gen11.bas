@@ -0,0 +1,14 @@
+19 LET i = i + 1
+90 IF 16 - a + 8 + 13 - i / 8 + i / 11 - c * b / n * n = 20 THEN 310
+390 IF i < n THEN 19
+50 LET b = 15
+16 LET a = 1
+310 LET b = 10
+380 PRINT c + 18 - - 19 - a + c * 13 - 10 + 5 + b
+10 LET i = 0
+15 LET n = 20
+17 LET b = 2
+18 LET c = 3
+240 LET a = 13 - c * c * 17 + 13
+350 PRINT - n * c + i - n * ( ( b ) + i )
+RUN
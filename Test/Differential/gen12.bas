@@ -0,0 +1,20 @@
+360 IF i < n THEN 19
+30 PRINT i
+17 LET b = 2
+100 LET b = n
+310 LET b = c + i + 6 + 14 - c + a * i * 2 + b
+250 PRINT i
+18 LET c = 3
+10 LET b = b + a
+170 IF - a * i < a / 13 - 15 - a + 18 - 16 - 13 THEN 310
+90 IF n < c THEN 350
+110 LET a = 19
+320 IF 11 < b THEN 350
+350 PRINT 11 / 16 - 18 - b + b / 18 - 14 * n - 17 - 4 * i
+240 PRINT ( 5 ) / c + b - 0 + c * - a - n + 4 / 10 - a
+60 PRINT c - 8 + 6 * n * c + n + 11 * 11
+19 LET i = i + 1
+10 LET i = 0
+15 LET n = 16
+16 LET a = 1
+RUN
@@ -0,0 +1,18 @@
+130 IF a + n + 14 / 2 - a * 7 - i + 2 < a + 2 - 13 + a + b - i - 13 - n + b THEN 200
+200 PRINT 9 + 6 - 19 - i + 7 - 6 - n - i
+360 LET b = ( b - 18 ) - 1 - 15 * 13 / 2 * 19 * n + - 14 + c
+10 LET i = 0
+400 IF i < n THEN 19
+310 LET c = 3
+390 LET a = 17 - - 15 * i
+16 LET a = 1
+290 LET i = i + 1
+300 LET a = 9 + 20 - 9 - ( 1 + b ) * - 0 + n * 3 + c / 14 - 16
+210 IF c + c = a + 20 + 6 + 1 + 16 THEN 390
+19 LET i = i + 1
+330 PRINT 9 / n
+18 LET c = 3
+17 LET b = 2
+120 LET b = ( a )
+15 LET n = 26
+RUN
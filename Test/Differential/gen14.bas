@@ -0,0 +1,18 @@
+180 LET i = i + 1
+16 LET a = 1
+90 PRINT a + a * a - 19 + 15 * b + b - n * 10
+10 PRINT - 18 / i + 1 - 14 + 4 - a + a - a / c / - c / 11
+310 PRINT i - - c + 2
+19 LET i = i + 1
+18 LET c = 3
+17 LET b = 2
+340 LET b = b + a
+240 LET b = c - 0 * 5 + b - ( a ) * - 3 + 15 - - n / a
+210 IF c * 5 + a / a + 8 + 19 - i * 2 * i * 15 + c / 11 * i = n THEN 230
+250 LET i = i + 1
+230 LET b = 12 * 1 * 0 + 11 - 17 - 13 + n / 20 - i * 12 * b + 8
+15 LET n = 26
+350 IF i < n THEN 19
+100 LET a = c + i - 14 * 16 + 6 - a + i - 15
+10 LET i = 0
+RUN
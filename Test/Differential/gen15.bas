@@ -0,0 +1,12 @@
+350 IF i < n THEN 19
+160 PRINT i
+16 LET a = 1
+10 LET i = 0
+180 PRINT c + - n / c
+19 LET i = i + 1
+340 LET c = a
+170 GOTO 180
+17 LET b = 2
+18 LET c = 3
+15 LET n = 10
+RUN
@@ -0,0 +1,16 @@
+19 LET i = i + 1
+150 LET a = 10
+310 PRINT b + c + 20 / a - 2 * a - 12 + c
+16 LET a = 1
+17 LET b = 2
+15 LET n = 28
+10 GOTO 290
+270 LET a = 19 * c * c + c + 2 + 15 * 14
+290 PRINT 0
+10 LET i = 0
+18 LET c = 3
+390 LET a = 12
+400 IF i < n THEN 19
+360 LET c = a
+190 GOTO 290
+RUN
@@ -0,0 +1,19 @@
+10 LET i = 0
+240 PRINT 0 - 9
+270 IF 20 * 3 + 17 + 17 * a + a / 10 * i + 13 / ( 6 ) > 16 * b * c * i * 4 * 7 * c + 15 / 16 THEN 200
+400 IF i < n THEN 19
+180 REM hello
+20 PRINT ( b + n - a - 15 ) * n + c + 18 + 6 * c
+330 LET a = i + ( 10 - 20 + c )
+130 PRINT n - 15 + b - 6 + n + 10 * 5 + c - n / n
+80 LET a = c * 18 + 11 * i * 15 - b - 4 - a + c + 13 - c
+17 LET b = 2
+16 LET a = 1
+15 LET n = 24
+190 PRINT i + 0
+120 GOTO 200
+200 LET b = b + a
+390 LET a = - b * 18 / c / b * b - i * c
+18 LET c = 3
+19 LET i = i + 1
+RUN
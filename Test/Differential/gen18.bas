@@ -0,0 +1,21 @@
+10 LET i = 0
+320 PRINT i
+40 LET i = i + 1
+130 LET i = i + 1
+80 PRINT i * a + 15 / a
+340 LET a = 14
+50 LET b = 0 - i
+19 LET i = i + 1
+350 IF i < n THEN 19
+230 LET b = n - n - 8 / 6 + 14 - c * c * 1 + 1 - i * 5 + n * c
+15 LET n = 9
+190 IF 12 + c + 5 / 1 * 13 * 16 = a + 9 THEN 200
+30 PRINT 9 * a
+17 LET b = 2
+330 LET b = a
+200 LET b = b + a
+90 LET i = i + 1
+260 LET b = - 2 * 15 / a + a
+16 LET a = 1
+18 LET c = 3
+RUN
@@ -0,0 +1,15 @@
+19 LET i = i + 1
+10 LET i = 0
+20 PRINT i
+60 LET a = 0
+340 PRINT 14
+280 LET c = a
+350 IF i < n THEN 19
+200 LET c = n * - 11 - - c * n * b + 10
+250 LET a = 18
+15 LET n = 5
+16 LET a = 1
+18 LET c = 3
+17 LET b = 2
+230 GOTO 250
+RUN
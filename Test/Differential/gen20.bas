@@ -0,0 +1,5 @@
+20 LET B = N * (A) * -B - C
+30 LET C = 2147483647 * (3 = 2) / N * C / -65536 - 2 * -2147483647 * A * 3
+40 LET N = N + 1
+10 PRINT 7
+RUN
@@ -0,0 +1,14 @@
+90 PRINT C * 7 / C / C + (3 = B) * N
+100 END
+80 LET N = N
+50 PRINT B / ((N = B)) - N
+110 PRINT C
+20 PRINT A
+10 PRINT 1
+30 LET N = N
+40 LET A = A - 7 / C - B
+130 INPUT C
+60 REM x */ y
+70 GOTO 80
+120 REM x */ y
+RUN
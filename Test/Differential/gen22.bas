@@ -0,0 +1,10 @@
+40 PRINT 7
+50 PRINT 100 + C
+70 PRINT (A = 100 / C - -B * -B)
+10 GOTO 30
+80 LET A = 2147483647 * 100 + (N = N) + (2 / 100) * (65536 - 100 / 2147483647 + C)
+30 REM x */ y
+60 PRINT -B + A * A / 2 / N + N * N / 7
+90 PRINT B
+20 LET B = C * ((B = 3)) * N / C / A / 3 - 0 * A
+RUN
@@ -0,0 +1,9 @@
+10 PRINT 65536
+60 LET C = ((0)) * C + B / 100 * -A / A - N / B - C + B * N
+70 LET N = N - -100 + 7 + 3 + 3
+80 LET A = B / 65536 / 100
+20 LET C = -A
+30 LET B = C - C * 3 / C * B / N - (B) * (N = B) / 100
+40 LET N = A / N / 100 - (C = 0 / N) + -7 / N - 2 * A * 2 - B
+50 LET C = C
+RUN
@@ -0,0 +1,9 @@
+30 PRINT C
+50 PRINT 3
+80 LET A = 1 - C - B / (3) / 0 * -(2)
+10 PRINT 65536
+60 IF ((65536) + A + B * (65536)) < A THEN 65
+70 PRINT ((B = (N) * A - 65536))
+40 LET N = N + 1
+20 INPUT B
+RUN
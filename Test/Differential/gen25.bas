@@ -0,0 +1,24 @@
+220 LET B = C + 0 / 65536 + 65536 - 2 - B + 0 - 65536 + N - 1 + N + C / 2 / 100
+90 INPUT A
+200 IF (C) / 2147483647 + N + A * B + 0 < 2147483647 / C - C THEN 220
+50 LET N = N
+40 LET A = 65536
+60 END
+150 LET A = 2147483647 * 2147483647
+110 LET C = B * A * (A) / 2147483647 * C - A
+230 PRINT 0 + 7 * 65536 + B / (3 = 2) - A + 3
+190 REM x */ y
+100 LET C = N + N + C
+10 GOTO 20
+180 GOTO 30
+70 PRINT B * B
+140 PRINT C
+20 PRINT -100
+170 LET N = N + 1
+30 LET C = (N = 65536) - (A)
+120 PRINT (C = B - A * N)
+210 PRINT 1 * (B = 7) * (C = 100) - 100 - C
+80 LET A = 3
+130 PRINT 3
+160 LET N = (C - 7 * A + C - A - 1 - 7)
+RUN
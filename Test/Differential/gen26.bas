@@ -0,0 +1,18 @@
+80 PRINT -3 + 2147483647 - N - B - (C + B)
+30 PRINT N + 1
+130 LET C = A + (3 = 2147483647) / 7
+170 PRINT (3 = A)
+160 LET N = -2 / (A - 100) + 2147483647
+10 PRINT 3
+90 LET B = B
+140 LET A = N
+40 LET C = A
+110 LET N = N + 1
+20 LET C = 0
+150 LET N = N
+120 LET B = 0 * (3 = 7 / 0 - A + A)
+70 INPUT N
+100 PRINT (-(B = 2147483647))
+60 LET B = (C = 2 - -A + B)
+50 PRINT 100
+RUN
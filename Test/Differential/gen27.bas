@@ -0,0 +1,5 @@
+40 LET N = 100
+20 IF --C / (A) = N THEN 25
+30 PRINT (A) - 1 + 100
+10 GOTO 15
+RUN
@@ -0,0 +1,12 @@
+30 LET C = --N
+110 IF -B < B THEN 50
+60 LET N = B
+10 GOTO 15
+100 IF 7 > B THEN 110
+80 LET B = A * N / 65536 * A + -7
+40 LET N = N + 1
+20 PRINT 2147483647 - (N) + N
+70 LET B = -2147483647 - 2 + A / B + N + B - 3 * (3 = C) + 3 - C
+50 PRINT B * N / N / 2 + C
+90 REM x */ y
+RUN
@@ -0,0 +1,7 @@
+60 LET N = C * A / B * 0 / 7 + B * (C = A) + (65536) + 2147483647 * B - N
+30 IF (((C))) = (C) * A / B + A * 100 THEN 50
+40 INPUT A
+20 INPUT B
+50 GOTO 60
+10 PRINT 2
+RUN
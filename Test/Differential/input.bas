@@ -0,0 +1,11 @@
+10 REM read numbers until a zero and print running sums
+20 LET s = 0
+30 INPUT n
+40 IF n = 0 THEN 80
+50 LET s = s + n
+60 PRINT s
+70 GOTO 30
+80 PRINT s * 2
+90 END
+100 PRINT 99
+RUN
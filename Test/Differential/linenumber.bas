@@ -0,0 +1,7 @@
+10 LET a = 1
+20 LET a = a * 2
+30 IF a < 1000 THEN 20
+40 PRINT a
+50 IF a > 1000 THEN 55
+60 PRINT 60
+RUN
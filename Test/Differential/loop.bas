@@ -0,0 +1,22 @@
+10 REM hot loop with guards that fail late
+20 LET i = 0
+30 LET s = 0
+40 LET i = i + 1
+50 IF i > 90 THEN 80
+60 LET s = s + i * 3 - i / 7
+70 GOTO 90
+80 LET s = s - 1000
+90 IF i < 120 THEN 40
+100 PRINT s
+110 PRINT i
+120 LET t = 0
+130 LET t = t + 1
+140 IF t = 50 THEN 160
+150 IF t < 100 THEN 130
+160 PRINT t
+170 LET u = 10
+180 LET u = u - 1
+190 PRINT 100 / u
+200 IF u > -5 THEN 180
+210 PRINT 0
+RUN
@@ -0,0 +1,16 @@
+10 LET a = 3
+20 LET b = (a = a * 2) + (c = a - 1) * ((a)) - -a
+30 PRINT a
+40 PRINT b
+50 PRINT c
+60 PRINT ((((a + b) * (c - a)) / (b - c + 1)) - ((a * a) / (c + 7))) * -(b / 3)
+70 LET d = 1 + 2 * 3 - 4 / 2 + (5 - 6) * 7
+80 PRINT d
+85 LET e = 4
+90 IF e + d < 0 THEN 110
+100 PRINT 100
+110 PRINT e
+120 LET f = a - b - c - d - e
+130 PRINT f * f * f
+140 PRINT 65536 * 65536
+RUN
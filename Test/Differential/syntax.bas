@@ -0,0 +1,10 @@
+10 LET a = 1
+20 LET = 5
+30 PRINT a +
+50 IF a THEN 10
+60 LET LET = 3
+70 PRINT a
+80 IF a = 1 THEN 100
+90 PRINT 90
+100 REM done
+RUN
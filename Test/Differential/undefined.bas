@@ -0,0 +1,7 @@
+10 LET i = 0
+20 LET i = i + 1
+30 IF i < 40 THEN 20
+40 PRINT i
+50 LET s = s + i
+60 PRINT s
+RUN